@@ -1,6 +1,7 @@
 #include <iostream>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <thread>
 #include <map>
@@ -11,523 +12,8479 @@
 #include <iomanip>
 #include <chrono>
 #include <queue>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <cstdint>
+#include <filesystem>
+#include <sstream>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <cmath>
+#include <climits>
+#include <future>
+#include <set>
+#include <list>
+#include <unordered_set>
+#include <random>
+#include <ctime>
+
+#ifdef _WIN32
+#include <io.h>
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifndef _WIN32
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define HAVE_AVX2_KERNELS 1 // Compiled with target attributes, chosen at run time
+#endif
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
 
 using namespace std;
 
-// --- Process Control Block ---
-struct ProcessControlBlock {
-    int pid;
-    string status; // "NEW", "READY", "RUNNING", "WAITING", "COMPLETED"
-    string transaction_id;
-    int arrival_time;
-    int burst_time;
-    int waiting_time;
-    int turnaround_time;
+// Flush stdio buffers and force the file contents to stable storage
+static bool syncFile(FILE* file) {
+    if (fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Index of the lowest set bit; word must be non-zero
+static inline int countTrailingZeros(unsigned long long word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, word);
+    return (int)index;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+// Index of the highest set bit counted from bit 63; word must be non-zero
+static inline int countLeadingZeros(unsigned long long word) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanReverse64(&index, word);
+    return 63 - (int)index;
+#else
+    return __builtin_clzll(word);
+#endif
+}
+
+// Balances are kept as fixed-point integer cents
+static long long toCents(double amount) {
+    return llround(amount * 100.0);
+}
+
+static string formatCents(long long cents) {
+    char buf[32];
+    unsigned long long magnitude = cents < 0 ? 0ULL - (unsigned long long)cents : (unsigned long long)cents;
+    snprintf(buf, sizeof(buf), "%s%llu.%02llu", cents < 0 ? "-" : "", magnitude / 100, magnitude % 100);
+    return buf;
+}
+
+static bool parseCents(const string& text, long long& cents) {
+    char* end = nullptr;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || *end != '\0') {
+        return false;
+    }
+    cents = toCents(value);
+    return true;
+}
+
+static string jsonEscape(const string& text) {
+    string quoted = "\"";
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += (char)c;
+        } else if (c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            quoted += buf;
+        } else {
+            quoted += (char)c;
+        }
+    }
+    return quoted + "\"";
+}
+
+// --- Asynchronous Logger ---
+// Hot paths copy a static format string and its raw arguments into a ring
+// owned by the calling thread and return. A background writer merges the
+// rings by timestamp, formats the text and does all console and file I/O, so
+// callers never format, flush or hold a lock while logging.
+enum class LogLevel : uint8_t { DEBUG, INFO, WARN, ERROR, OFF };
+
+struct LogRecord {
+    static const size_t MAX_ARGS = 4;
+    static const size_t TEXT_BYTES = 240;
+    enum ArgType : uint8_t { INTEGER, REAL, TEXT };
+
+    struct Arg {
+        ArgType type;
+        uint16_t offset; // TEXT: position in text
+        uint16_t length;
+        union {
+            long long integer;
+            double real;
+        };
+    };
+
+    long long timestamp_ns;  // system_clock
+    LogLevel level;
+    uint8_t arg_count;
+    uint16_t text_used;
+    uint32_t thread_id;
+    const char* component;   // String literal
+    const char* format;      // String literal, {} marks each argument
+    Arg args[MAX_ARGS];
+    char text[TEXT_BYTES];   // Copies of string arguments (truncated to fit)
+
+    template <typename T>
+    typename enable_if<is_integral<T>::value>::type add(T value) {
+        if (arg_count < MAX_ARGS) {
+            Arg& arg = args[arg_count++];
+            arg.type = INTEGER;
+            arg.integer = (long long)value;
+        }
+    }
+
+    void add(double value) {
+        if (arg_count < MAX_ARGS) {
+            Arg& arg = args[arg_count++];
+            arg.type = REAL;
+            arg.real = value;
+        }
+    }
+
+    void add(const char* data, size_t size) {
+        if (arg_count < MAX_ARGS) {
+            Arg& arg = args[arg_count++];
+            arg.type = TEXT;
+            arg.offset = text_used;
+            arg.length = (uint16_t)min(size, TEXT_BYTES - text_used);
+            memcpy(text + text_used, data, arg.length);
+            text_used += arg.length;
+        }
+    }
+
+    void add(const string& value) {
+        add(value.data(), value.size());
+    }
+
+    void add(const char* value) {
+        add(value, strlen(value));
+    }
+
+    // Runs on the writer thread only
+    string message() const {
+        string out;
+        size_t next_arg = 0;
+        for (const char* p = format; *p; p++) {
+            if (p[0] == '{' && p[1] == '}' && next_arg < arg_count) {
+                out += argText(args[next_arg++]);
+                p++;
+            } else {
+                out += *p;
+            }
+        }
+        return out;
+    }
+
+    string argText(const Arg& arg) const {
+        if (arg.type == TEXT) {
+            return string(text + arg.offset, arg.length);
+        }
+        char buf[32];
+        if (arg.type == INTEGER) {
+            snprintf(buf, sizeof(buf), "%lld", arg.integer);
+        } else {
+            snprintf(buf, sizeof(buf), "%g", arg.real); // Same as cout's default
+        }
+        return buf;
+    }
+};
+
+// Single-producer (the owning thread), single-consumer (the writer) ring
+struct LogRing {
+    static const size_t CAPACITY = 1024;
+
+    alignas(64) atomic<size_t> head{0}; // Next slot the producer writes
+    alignas(64) atomic<size_t> tail{0}; // Next slot the writer reads
+    atomic<bool> abandoned{false};      // Owning thread has exited
+    LogRecord records[CAPACITY];
+};
+
+class Logger {
+private:
+    atomic<LogLevel> min_level{LogLevel::INFO};
+    atomic<bool> console_enabled{true};
+
+    mutex rings_mutex; // Guards ring registration, never held during I/O
+    vector<shared_ptr<LogRing>> rings;
+
+    mutex wake_mutex;
+    condition_variable wake_cv;    // Wakes the writer early
+    condition_variable drained_cv; // Wakes flush() callers after each pass
+    bool wake_requested = false;
+    bool stopping = false;
+
+    ofstream json_out;
+    atomic<bool> json_enabled{false}; // Set once json_out is open
+    thread writer;
+
+    LogRing& localRing() {
+        struct Owner {
+            shared_ptr<LogRing> ring;
+            ~Owner() {
+                if (ring) {
+                    ring->abandoned.store(true, memory_order_release);
+                }
+            }
+        };
+        thread_local Owner owner;
+        if (!owner.ring) {
+            owner.ring = make_shared<LogRing>();
+            lock_guard<mutex> lock(rings_mutex);
+            rings.push_back(owner.ring);
+        }
+        return *owner.ring;
+    }
+
+    // Defined outside the log() template so every instantiation sees the same id
+    static uint32_t currentThreadId() {
+        static atomic<uint32_t> next_thread_id{1};
+        thread_local uint32_t thread_id = next_thread_id.fetch_add(1, memory_order_relaxed);
+        return thread_id;
+    }
+
+    void wakeWriter() {
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            wake_requested = true;
+        }
+        wake_cv.notify_one();
+    }
+
+    struct PendingLine {
+        long long timestamp_ns;
+        uint32_t thread_id;
+        string text;
+        string json;
+    };
+
+    static const char* levelName(LogLevel level) {
+        switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        default: return "ERROR";
+        }
+    }
+
+    string toJson(const LogRecord& record, const string& message) const {
+        string line = "{\"ts_ns\": " + to_string(record.timestamp_ns) + ", \"level\": \"" + levelName(record.level)
+                    + "\", \"thread\": " + to_string(record.thread_id) + ", \"component\": "
+                    + jsonEscape(record.component) + ", \"message\": " + jsonEscape(message) + ", \"args\": [";
+        for (size_t i = 0; i < record.arg_count; i++) {
+            const LogRecord::Arg& arg = record.args[i];
+            line += i ? ", " : "";
+            line += arg.type == LogRecord::TEXT ? jsonEscape(record.argText(arg)) : record.argText(arg);
+        }
+        return line + "]}";
+    }
+
+    // Format and write everything currently queued; returns the record count
+    size_t drainOnce() {
+        vector<shared_ptr<LogRing>> snapshot;
+        {
+            lock_guard<mutex> lock(rings_mutex);
+            snapshot = rings;
+        }
+        bool json = json_enabled.load(memory_order_acquire);
+        vector<PendingLine> lines;
+        for (const auto& ring : snapshot) {
+            size_t tail = ring->tail.load(memory_order_relaxed);
+            size_t head = ring->head.load(memory_order_acquire);
+            for (; tail != head; tail++) {
+                const LogRecord& record = ring->records[tail % LogRing::CAPACITY];
+                PendingLine line{record.timestamp_ns, record.thread_id, record.message(), string()};
+                if (json) {
+                    line.json = toJson(record, line.text);
+                }
+                lines.push_back(move(line));
+            }
+            ring->tail.store(tail, memory_order_release);
+        }
+        {
+            // Rings of exited threads are dropped once drained
+            lock_guard<mutex> lock(rings_mutex);
+            rings.erase(remove_if(rings.begin(), rings.end(), [](const shared_ptr<LogRing>& ring) {
+                            return ring->abandoned.load(memory_order_acquire)
+                                   && ring->tail.load(memory_order_relaxed) == ring->head.load(memory_order_acquire);
+                        }),
+                        rings.end());
+        }
+        if (lines.empty()) {
+            return 0;
+        }
+        stable_sort(lines.begin(), lines.end(), [](const PendingLine& a, const PendingLine& b) {
+            return a.timestamp_ns < b.timestamp_ns;
+        });
+        bool console = console_enabled.load(memory_order_relaxed);
+        for (const auto& line : lines) {
+            if (console) {
+                cout << line.text << '\n';
+            }
+            if (json) {
+                json_out << line.json << '\n';
+            }
+        }
+        cout.flush();
+        if (json) {
+            json_out.flush();
+        }
+        return lines.size();
+    }
+
+    void writerLoop() {
+        while (true) {
+            size_t written = drainOnce();
+            unique_lock<mutex> lock(wake_mutex);
+            drained_cv.notify_all();
+            if (stopping && written == 0) {
+                return;
+            }
+            if (written == 0) {
+                wake_cv.wait_for(lock, chrono::milliseconds(20), [this] { return wake_requested || stopping; });
+            }
+            wake_requested = false;
+        }
+    }
+
+    Logger() : writer(&Logger::writerLoop, this) {}
+
+public:
+    static Logger& instance() {
+        static Logger logger;
+        return logger;
+    }
+
+    // Writes everything still queued before the writer exits
+    ~Logger() {
+        {
+            lock_guard<mutex> lock(wake_mutex);
+            stopping = true;
+        }
+        wake_cv.notify_one();
+        writer.join();
+    }
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void setLevel(LogLevel level) {
+        min_level.store(level, memory_order_relaxed);
+    }
+
+    bool enabled(LogLevel level) const {
+        return level >= min_level.load(memory_order_relaxed);
+    }
+
+    void setConsoleOutput(bool enabled) {
+        console_enabled.store(enabled, memory_order_relaxed);
+    }
+
+    // Also write every record as one JSON object per line
+    bool openJsonOutput(const string& path) {
+        if (json_enabled.load(memory_order_acquire)) {
+            return false; // Only one JSON file per run
+        }
+        json_out.open(path, ios::app);
+        json_enabled.store(json_out.is_open(), memory_order_release);
+        return json_out.is_open();
+    }
+
+    template <typename... Args>
+    void log(LogLevel level, const char* component, const char* format, const Args&... args) {
+        if (!enabled(level)) {
+            return;
+        }
+        LogRing& ring = localRing();
+        size_t head = ring.head.load(memory_order_relaxed);
+        while (head - ring.tail.load(memory_order_acquire) >= LogRing::CAPACITY) {
+            wakeWriter(); // Ring full: let the writer catch up
+            this_thread::yield();
+        }
+        LogRecord& record = ring.records[head % LogRing::CAPACITY];
+        record.timestamp_ns = chrono::duration_cast<chrono::nanoseconds>(
+                                  chrono::system_clock::now().time_since_epoch()).count();
+        record.level = level;
+        record.arg_count = 0;
+        record.text_used = 0;
+        record.thread_id = currentThreadId();
+        record.component = component;
+        record.format = format;
+        (record.add(args), ...);
+        ring.head.store(head + 1, memory_order_release);
+    }
+
+    template <typename... Args>
+    void info(const char* component, const char* format, const Args&... args) {
+        log(LogLevel::INFO, component, format, args...);
+    }
+
+    template <typename... Args>
+    void warn(const char* component, const char* format, const Args&... args) {
+        log(LogLevel::WARN, component, format, args...);
+    }
+
+    template <typename... Args>
+    void error(const char* component, const char* format, const Args&... args) {
+        log(LogLevel::ERROR, component, format, args...);
+    }
+
+    // Block until everything logged so far has been written. Interactive code
+    // calls this before printing directly so console output stays in order.
+    void flush() {
+        vector<pair<shared_ptr<LogRing>, size_t>> targets;
+        {
+            lock_guard<mutex> lock(rings_mutex);
+            for (const auto& ring : rings) {
+                size_t head = ring->head.load(memory_order_acquire);
+                if (ring->tail.load(memory_order_acquire) != head) {
+                    targets.push_back({ring, head});
+                }
+            }
+        }
+        if (targets.empty()) {
+            return;
+        }
+        unique_lock<mutex> lock(wake_mutex);
+        wake_requested = true;
+        wake_cv.notify_one();
+        drained_cv.wait(lock, [&targets] {
+            for (const auto& target : targets) {
+                if (target.first->tail.load(memory_order_acquire) < target.second) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+};
+
+static Logger& logger() {
+    return Logger::instance();
+}
+
+// --- Instrumentation ---
+// Transaction latency and lock wait time are recorded into shards owned by
+// the calling thread, so recording is a few relaxed stores to memory no other
+// thread writes. A snapshot sums the shards; shards of exited threads are
+// folded into a retired total. Nothing is recorded until metrics are enabled.
+enum class Metric : uint8_t {
+    TXN_DEPOSIT, TXN_WITHDRAW, TXN_BALANCE, TXN_TRANSFER, TXN_BATCH,
+    LOCK_PROCESS_TABLE, LOCK_WAL, LOCK_ACCOUNT_SHARD, LOCK_ACCOUNT_STRIPE, LOCK_IPC_REPLY,
+    COUNT
+};
+
+static const size_t METRIC_COUNT = (size_t)Metric::COUNT;
+
+static bool isLockMetric(Metric metric) {
+    return metric >= Metric::LOCK_PROCESS_TABLE;
+}
+
+// Label value in the exported metrics
+static const char* metricLabel(Metric metric) {
+    switch (metric) {
+    case Metric::TXN_DEPOSIT: return "deposit";
+    case Metric::TXN_WITHDRAW: return "withdraw";
+    case Metric::TXN_BALANCE: return "balance";
+    case Metric::TXN_TRANSFER: return "transfer";
+    case Metric::TXN_BATCH: return "batch";
+    case Metric::LOCK_PROCESS_TABLE: return "process_table";
+    case Metric::LOCK_WAL: return "wal";
+    case Metric::LOCK_ACCOUNT_SHARD: return "account_shard";
+    case Metric::LOCK_ACCOUNT_STRIPE: return "account_stripe";
+    default: return "ipc_reply_slot";
+    }
+}
+
+// Log-linear buckets in the style of HdrHistogram: 8 sub-buckets per power
+// of two, so a value is never more than 12.5% above its bucket's lower bound.
+// Used for latencies here and for trace distance distributions.
+struct LogLinearBuckets {
+    static const int SUB_BITS = 3;
+    static const int SUB_BUCKETS = 1 << SUB_BITS;
+    static const int MAX_BIT = 40; // About 18 minutes in nanoseconds
+    static const int COUNT = (MAX_BIT - SUB_BITS + 2) * SUB_BUCKETS;
+
+    static int indexOf(uint64_t value) {
+        if (value < (uint64_t)SUB_BUCKETS) {
+            return (int)value;
+        }
+        int top = 63 - countLeadingZeros(value);
+        int index = (top - SUB_BITS + 1) * SUB_BUCKETS + (int)((value >> (top - SUB_BITS)) & (SUB_BUCKETS - 1));
+        return min(index, COUNT - 1);
+    }
+
+    static uint64_t lowerBound(int index) {
+        if (index < SUB_BUCKETS) {
+            return (uint64_t)index;
+        }
+        int top = index / SUB_BUCKETS + SUB_BITS - 1;
+        return (uint64_t)(SUB_BUCKETS + index % SUB_BUCKETS) << (top - SUB_BITS);
+    }
+};
+
+// Written only by the owning thread; readers may see a sample half-recorded
+// (count bumped, bucket not yet), which is harmless for monitoring
+struct MetricsShard {
+    struct Cell {
+        atomic<uint64_t> samples;      // Transactions, or contended lock waits
+        atomic<uint64_t> sum_ns;
+        atomic<uint64_t> failures;     // Transactions that did not apply
+        atomic<uint64_t> acquisitions; // Locks only: contended or not
+        atomic<uint64_t> buckets[LogLinearBuckets::COUNT];
+    };
+
+    Cell cells[METRIC_COUNT];
+    atomic<bool> abandoned{false};
+
+    MetricsShard() {
+        for (auto& cell : cells) {
+            cell.samples.store(0, memory_order_relaxed);
+            cell.sum_ns.store(0, memory_order_relaxed);
+            cell.failures.store(0, memory_order_relaxed);
+            cell.acquisitions.store(0, memory_order_relaxed);
+            for (auto& bucket : cell.buckets) {
+                bucket.store(0, memory_order_relaxed);
+            }
+        }
+    }
+
+    static void bump(atomic<uint64_t>& counter, uint64_t amount = 1) {
+        counter.store(counter.load(memory_order_relaxed) + amount, memory_order_relaxed);
+    }
+};
+
+struct MetricTotals {
+    uint64_t samples = 0;
+    uint64_t sum_ns = 0;
+    uint64_t failures = 0;
+    uint64_t acquisitions = 0;
+    vector<uint64_t> buckets = vector<uint64_t>(LogLinearBuckets::COUNT);
+
+    void add(const MetricsShard::Cell& cell) {
+        samples += cell.samples.load(memory_order_relaxed);
+        sum_ns += cell.sum_ns.load(memory_order_relaxed);
+        failures += cell.failures.load(memory_order_relaxed);
+        acquisitions += cell.acquisitions.load(memory_order_relaxed);
+        for (int i = 0; i < LogLinearBuckets::COUNT; i++) {
+            buckets[i] += cell.buckets[i].load(memory_order_relaxed);
+        }
+    }
+
+    void add(const MetricTotals& other) {
+        samples += other.samples;
+        sum_ns += other.sum_ns;
+        failures += other.failures;
+        acquisitions += other.acquisitions;
+        for (int i = 0; i < LogLinearBuckets::COUNT; i++) {
+            buckets[i] += other.buckets[i];
+        }
+    }
+
+    // Samples at most value_ns, for Prometheus "le" buckets. A sample equal to
+    // value_ns shares its bucket with slightly larger ones (up to 1/8 more),
+    // which are counted too, so the result never undercounts.
+    uint64_t countAtMost(uint64_t value_ns) const {
+        uint64_t total = 0;
+        for (int i = 0; i <= LogLinearBuckets::indexOf(value_ns); i++) {
+            total += buckets[i];
+        }
+        return total;
+    }
+
+    // Upper bound of the bucket holding the q-th quantile, in nanoseconds
+    uint64_t quantile(double q) const {
+        uint64_t target = (uint64_t)ceil(q * samples), seen = 0;
+        for (int i = 0; i < LogLinearBuckets::COUNT; i++) {
+            seen += buckets[i];
+            if (seen >= target && seen > 0) {
+                return i + 1 < LogLinearBuckets::COUNT ? LogLinearBuckets::lowerBound(i + 1) : LogLinearBuckets::lowerBound(i);
+            }
+        }
+        return 0;
+    }
+};
+
+// Point-in-time value supplied by a collector, e.g. a queue depth
+struct GaugeSample {
+    string name;   // Prometheus metric name
+    string help;
+    string labels; // Rendered label set without braces, may be empty
+    double value;
+};
+
+class Metrics {
+private:
+    atomic<bool> active{false};
+
+    mutex shards_mutex; // Guards registration and the retired totals
+    vector<shared_ptr<MetricsShard>> shards;
+    vector<MetricTotals> retired = vector<MetricTotals>(METRIC_COUNT);
+
+    mutex collectors_mutex;
+    map<int, function<void(vector<GaugeSample>&)>> collectors;
+    int next_collector = 1;
+
+    MetricsShard& localShard() {
+        struct Owner {
+            shared_ptr<MetricsShard> shard;
+            ~Owner() {
+                if (shard) {
+                    shard->abandoned.store(true, memory_order_release);
+                }
+            }
+        };
+        thread_local Owner owner;
+        if (!owner.shard) {
+            owner.shard = make_shared<MetricsShard>();
+            lock_guard<mutex> lock(shards_mutex);
+            shards.push_back(owner.shard);
+        }
+        return *owner.shard;
+    }
+
+    static string seconds(uint64_t ns) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.9g", ns / 1e9);
+        return buf;
+    }
+
+    // Cumulative buckets at powers of two from 256 ns to about 17 s
+    static void writeHistogram(ostream& out, const string& name, const string& label, const MetricTotals& totals) {
+        for (int bit = 8; bit <= 34; bit += 2) {
+            uint64_t bound = 1ULL << bit;
+            out << name << "_bucket{" << label << ",le=\"" << seconds(bound) << "\"} " << totals.countAtMost(bound) << "\n";
+        }
+        out << name << "_bucket{" << label << ",le=\"+Inf\"} " << totals.samples << "\n";
+        out << name << "_sum{" << label << "} " << seconds(totals.sum_ns) << "\n";
+        out << name << "_count{" << label << "} " << totals.samples << "\n";
+    }
+
+    Metrics() {}
+
+public:
+    static Metrics& instance() {
+        static Metrics metrics;
+        return metrics;
+    }
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    void setEnabled(bool enabled) {
+        active.store(enabled, memory_order_relaxed);
+    }
+
+    bool enabled() const {
+        return active.load(memory_order_relaxed);
+    }
+
+    static long long nowNs() {
+        return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    // Start time for finish(); 0 while disabled, so no clock is read
+    long long start() const {
+        return enabled() ? nowNs() : 0;
+    }
+
+    void finish(Metric metric, long long started_ns, bool ok = true) {
+        if (started_ns == 0) {
+            return;
+        }
+        uint64_t elapsed = (uint64_t)max(0LL, nowNs() - started_ns);
+        MetricsShard::Cell& cell = localShard().cells[(size_t)metric];
+        MetricsShard::bump(cell.samples);
+        MetricsShard::bump(cell.sum_ns, elapsed);
+        MetricsShard::bump(cell.buckets[LogLinearBuckets::indexOf(elapsed)]);
+        if (!ok) {
+            MetricsShard::bump(cell.failures);
+        }
+    }
+
+    void countAcquisition(Metric lock_metric) {
+        MetricsShard::bump(localShard().cells[(size_t)lock_metric].acquisitions);
+    }
+
+    // Sum every shard; shards of exited threads move into the retired totals
+    vector<MetricTotals> snapshot() {
+        lock_guard<mutex> lock(shards_mutex);
+        vector<MetricTotals> totals = retired;
+        for (auto it = shards.begin(); it != shards.end();) {
+            bool exited = (*it)->abandoned.load(memory_order_acquire);
+            for (size_t m = 0; m < METRIC_COUNT; m++) {
+                totals[m].add((*it)->cells[m]);
+                if (exited) {
+                    retired[m].add((*it)->cells[m]);
+                }
+            }
+            it = exited ? shards.erase(it) : it + 1;
+        }
+        return totals;
+    }
+
+    // Register a function that appends gauges at each export; returns an id
+    // for removeCollector
+    int addCollector(function<void(vector<GaugeSample>&)> collector) {
+        lock_guard<mutex> lock(collectors_mutex);
+        collectors[next_collector] = move(collector);
+        return next_collector++;
+    }
+
+    void removeCollector(int id) {
+        lock_guard<mutex> lock(collectors_mutex);
+        collectors.erase(id);
+    }
+
+    // Prometheus text exposition format (version 0.0.4)
+    string prometheusText() {
+        vector<MetricTotals> totals = snapshot();
+        ostringstream out;
+        const double QUANTILES[] = {0.5, 0.9, 0.99, 0.999};
+
+        out << "# HELP os_transaction_duration_seconds Transaction latency by action.\n"
+            << "# TYPE os_transaction_duration_seconds histogram\n";
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (!isLockMetric((Metric)m)) {
+                writeHistogram(out, "os_transaction_duration_seconds", "action=\"" + string(metricLabel((Metric)m)) + "\"", totals[m]);
+            }
+        }
+        out << "# HELP os_transaction_latency_quantile_seconds Transaction latency quantiles (bucket upper bounds).\n"
+            << "# TYPE os_transaction_latency_quantile_seconds gauge\n";
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (!isLockMetric((Metric)m)) {
+                for (double q : QUANTILES) {
+                    out << "os_transaction_latency_quantile_seconds{action=\"" << metricLabel((Metric)m) << "\",quantile=\""
+                        << q << "\"} " << seconds(totals[m].quantile(q)) << "\n";
+                }
+            }
+        }
+        out << "# HELP os_transaction_failures_total Transactions rejected (unknown account, insufficient balance).\n"
+            << "# TYPE os_transaction_failures_total counter\n";
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (!isLockMetric((Metric)m)) {
+                out << "os_transaction_failures_total{action=\"" << metricLabel((Metric)m) << "\"} " << totals[m].failures << "\n";
+            }
+        }
+
+        out << "# HELP os_lock_acquisitions_total Instrumented lock acquisitions.\n"
+            << "# TYPE os_lock_acquisitions_total counter\n";
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (isLockMetric((Metric)m)) {
+                out << "os_lock_acquisitions_total{lock=\"" << metricLabel((Metric)m) << "\"} " << totals[m].acquisitions << "\n";
+            }
+        }
+        out << "# HELP os_lock_wait_seconds Time spent blocked on a lock that was already held.\n"
+            << "# TYPE os_lock_wait_seconds histogram\n";
+        for (size_t m = 0; m < METRIC_COUNT; m++) {
+            if (isLockMetric((Metric)m)) {
+                writeHistogram(out, "os_lock_wait_seconds", "lock=\"" + string(metricLabel((Metric)m)) + "\"", totals[m]);
+            }
+        }
+
+        vector<GaugeSample> gauges;
+        {
+            lock_guard<mutex> lock(collectors_mutex);
+            for (const auto& collector : collectors) {
+                collector.second(gauges);
+            }
+        }
+        stable_sort(gauges.begin(), gauges.end(), [](const GaugeSample& a, const GaugeSample& b) { return a.name < b.name; });
+        for (size_t i = 0; i < gauges.size(); i++) {
+            if (i == 0 || gauges[i].name != gauges[i - 1].name) {
+                out << "# HELP " << gauges[i].name << " " << gauges[i].help << "\n# TYPE " << gauges[i].name << " gauge\n";
+            }
+            out << gauges[i].name;
+            if (!gauges[i].labels.empty()) {
+                out << "{" << gauges[i].labels << "}";
+            }
+            out << " " << gauges[i].value << "\n";
+        }
+        return out.str();
+    }
+};
+
+static Metrics& metrics() {
+    return Metrics::instance();
+}
+
+// Lock m, timing the wait only when the lock is already held. Pair it with
+// adopt_lock: lock_guard<mutex> lock(timedLock(m, Metric::LOCK_WAL), adopt_lock);
+template <typename Mutex>
+static Mutex& timedLock(Mutex& m, Metric lock_metric) {
+    Metrics& registry = metrics();
+    if (m.try_lock()) {
+        if (registry.enabled()) {
+            registry.countAcquisition(lock_metric);
+        }
+        return m;
+    }
+    long long started = registry.start();
+    m.lock();
+    if (started) {
+        registry.countAcquisition(lock_metric);
+        registry.finish(lock_metric, started);
+    }
+    return m;
+}
+
+// Writes the Prometheus text to a file (replaced atomically every interval)
+// and/or serves it on a Unix socket, from one background thread
+class MetricsExporter {
+private:
+    string file_path;
+    string socket_path;
+    chrono::milliseconds interval;
+    int listen_fd = -1;
+    atomic<bool> stopping{false};
+    thread worker;
+
+    bool writeFile() {
+        string tmp_path = file_path + ".tmp";
+        {
+            ofstream out(tmp_path, ios::trunc);
+            if (!out) {
+                return false;
+            }
+            out << metrics().prometheusText();
+        }
+        error_code error;
+        filesystem::rename(tmp_path, file_path, error);
+        return !error;
+    }
+
+#ifndef _WIN32
+    // Answers any request (plain connect or HTTP GET) with the current text,
+    // so both "nc -U" and "curl --unix-socket" work
+    void serveClient(int client) {
+        pollfd request{client, POLLIN, 0};
+        if (poll(&request, 1, 100) > 0) {
+            char discard[4096];
+            if (read(client, discard, sizeof(discard)) < 0) {
+                // Nothing to do; the reply is the same either way
+            }
+        }
+        string body = metrics().prometheusText();
+        string reply = "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: "
+                     + to_string(body.size()) + "\r\n\r\n" + body;
+        size_t sent = 0;
+        while (sent < reply.size()) {
+            ssize_t n = write(client, reply.data() + sent, reply.size() - sent);
+            if (n <= 0) {
+                break;
+            }
+            sent += (size_t)n;
+        }
+        ::close(client);
+    }
+
+    bool openSocket() {
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        if (socket_path.size() >= sizeof(address.sun_path)) {
+            return false;
+        }
+        address.sun_family = AF_UNIX;
+        memcpy(address.sun_path, socket_path.c_str(), socket_path.size());
+        unlink(socket_path.c_str());
+        listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (listen_fd < 0 || ::bind(listen_fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd, 16) != 0) {
+            if (listen_fd >= 0) {
+                ::close(listen_fd);
+                listen_fd = -1;
+            }
+            return false;
+        }
+        return true;
+    }
+#endif
+
+    void run() {
+        auto next_write = chrono::steady_clock::now();
+        while (!stopping.load(memory_order_acquire)) {
+            if (!file_path.empty() && chrono::steady_clock::now() >= next_write) {
+                writeFile();
+                next_write = chrono::steady_clock::now() + interval;
+            }
+#ifndef _WIN32
+            if (listen_fd >= 0) {
+                pollfd waiting{listen_fd, POLLIN, 0};
+                if (poll(&waiting, 1, 100) > 0) {
+                    int client = accept(listen_fd, nullptr, nullptr);
+                    if (client >= 0) {
+                        serveClient(client);
+                    }
+                }
+                continue;
+            }
+#endif
+            this_thread::sleep_for(chrono::milliseconds(100));
+        }
+    }
+
+public:
+    MetricsExporter() : interval(1000) {}
+
+    ~MetricsExporter() {
+        stop();
+    }
+
+    // Either path may be empty. Enables metrics collection.
+    bool start(const string& file, const string& socket_file, chrono::milliseconds period = chrono::milliseconds(1000)) {
+        file_path = file;
+        socket_path = socket_file;
+        interval = period;
+        if (!socket_path.empty()) {
+#ifndef _WIN32
+            if (!openSocket()) {
+                return false;
+            }
+#else
+            return false; // Unix sockets need a POSIX system
+#endif
+        }
+        if (!file_path.empty() && !writeFile()) {
+            return false;
+        }
+        metrics().setEnabled(true);
+        worker = thread(&MetricsExporter::run, this);
+        return true;
+    }
+
+    // Final file write so the last numbers of the run are kept
+    void stop() {
+        if (!worker.joinable()) {
+            return;
+        }
+        stopping.store(true, memory_order_release);
+        worker.join();
+        if (!file_path.empty()) {
+            writeFile();
+        }
+#ifndef _WIN32
+        if (listen_fd >= 0) {
+            ::close(listen_fd);
+            unlink(socket_path.c_str());
+            listen_fd = -1;
+        }
+#endif
+    }
+};
+
+// --- Process Control Block ---
+enum class ProcessState : uint8_t { NEW, READY, RUNNING, WAITING, COMPLETED };
+
+static const char* processStateName(ProcessState state) {
+    switch (state) {
+    case ProcessState::NEW: return "NEW";
+    case ProcessState::READY: return "READY";
+    case ProcessState::RUNNING: return "RUNNING";
+    case ProcessState::WAITING: return "WAITING";
+    default: return "COMPLETED";
+    }
+}
+
+class PageTable; // Defined with the virtual memory code
+
+// Lives in a PID-indexed slot of the process table. Fields that change while
+// the process runs are atomic so they can be updated without the table lock.
+struct ProcessControlBlock {
+    int pid = 0;
+    atomic<ProcessState> status{ProcessState::NEW};
+    string transaction_id; // Written only while the slot is being (re)allocated
+    int arrival_time = 0;
+    int burst_time = 1;
+    atomic<int> waiting_time{0};
+    atomic<int> turnaround_time{0};
+    atomic<uint64_t> affinity_mask{0}; // Bit n allows CPU n; 0 means any CPU
+    shared_ptr<PageTable> page_table;  // Address space, set by VirtualMemory::attach
+    atomic<bool> in_use{false};
+};
+
+// --- Process Table ---
+// PCBs live in fixed chunks of slots indexed by PID, so finding a process is
+// one array lookup and slots never move. The table lock only guards PID
+// allocation; released PIDs go on a free list and are reused.
+class ProcessTable {
+private:
+    static const int CHUNK_BITS = 10;
+    static const int CHUNK_SIZE = 1 << CHUNK_BITS;
+    static const int MAX_CHUNKS = 4096; // Up to 4M PIDs
+
+    atomic<ProcessControlBlock*> chunks[MAX_CHUNKS];
+    mutex table_mutex;
+    vector<int> free_pids;
+    atomic<int> next_pid; // One past the highest PID handed out so far
+
+    ProcessControlBlock* slot(int pid) const {
+        if (pid <= 0 || pid >= next_pid.load(memory_order_acquire)) {
+            return nullptr;
+        }
+        ProcessControlBlock* chunk = chunks[pid >> CHUNK_BITS].load(memory_order_acquire);
+        return chunk ? &chunk[pid & (CHUNK_SIZE - 1)] : nullptr;
+    }
+
+    ProcessControlBlock* liveSlot(int pid) const {
+        ProcessControlBlock* pcb = slot(pid);
+        return pcb && pcb->in_use.load(memory_order_acquire) ? pcb : nullptr;
+    }
+
+public:
+    // Iterates the live PCBs in PID order without copying them. Processes
+    // created after the snapshot was taken are not visited.
+    class Snapshot {
+    private:
+        const ProcessTable* table;
+        int end_pid;
+
+    public:
+        class iterator {
+        private:
+            const ProcessTable* table;
+            int pid;
+            int end_pid;
+
+            void skipFree() {
+                while (pid < end_pid && !table->liveSlot(pid)) {
+                    pid++;
+                }
+            }
+
+        public:
+            iterator(const ProcessTable* t, int start, int end) : table(t), pid(start), end_pid(end) {
+                skipFree();
+            }
+            const ProcessControlBlock& operator*() const {
+                return *table->slot(pid);
+            }
+            iterator& operator++() {
+                pid++;
+                skipFree();
+                return *this;
+            }
+            bool operator!=(const iterator& other) const {
+                return pid != other.pid;
+            }
+        };
+
+        Snapshot(const ProcessTable* t, int end) : table(t), end_pid(end) {}
+        iterator begin() const {
+            return iterator(table, 1, end_pid);
+        }
+        iterator end() const {
+            return iterator(table, end_pid, end_pid);
+        }
+    };
+
+    ProcessTable() : next_pid(1) {
+        for (auto& chunk : chunks) {
+            chunk.store(nullptr, memory_order_relaxed);
+        }
+    }
+
+    ~ProcessTable() {
+        for (auto& chunk : chunks) {
+            delete[] chunk.load(memory_order_relaxed);
+        }
+    }
+
+    ProcessTable(const ProcessTable&) = delete;
+    ProcessTable& operator=(const ProcessTable&) = delete;
+
+    // Returns -1 when every PID is in use
+    int createProcess(const string& transaction_id, int arrival_time = 0, int burst_time = 1) {
+        ProcessControlBlock* pcb;
+        int pid;
+        {
+            lock_guard<mutex> lock(timedLock(table_mutex, Metric::LOCK_PROCESS_TABLE), adopt_lock);
+            if (!free_pids.empty()) {
+                pid = free_pids.back();
+                free_pids.pop_back();
+            } else {
+                pid = next_pid.load(memory_order_relaxed);
+                if ((pid >> CHUNK_BITS) >= MAX_CHUNKS) {
+                    logger().error("process_table", "[PROCESS TABLE] No free PID for Transaction: {}", transaction_id);
+                    return -1;
+                }
+                if (!chunks[pid >> CHUNK_BITS].load(memory_order_relaxed)) {
+                    chunks[pid >> CHUNK_BITS].store(new ProcessControlBlock[CHUNK_SIZE], memory_order_release);
+                }
+                next_pid.store(pid + 1, memory_order_release);
+            }
+            pcb = slot(pid);
+            pcb->pid = pid;
+            pcb->transaction_id = transaction_id;
+            pcb->arrival_time = arrival_time;
+            pcb->burst_time = burst_time;
+            pcb->waiting_time.store(0, memory_order_relaxed);
+            pcb->turnaround_time.store(0, memory_order_relaxed);
+            pcb->affinity_mask.store(0, memory_order_relaxed);
+            pcb->page_table.reset();
+            pcb->status.store(ProcessState::READY, memory_order_relaxed);
+            pcb->in_use.store(true, memory_order_release);
+        }
+        logger().info("process_table", "[PROCESS TABLE] Created Process PID: {} for Transaction: {}", pid, transaction_id);
+        return pid;
+    }
+
+    // Lock-free; returns false for an unknown PID
+    bool updateStatus(int pid, ProcessState new_status) {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (!pcb) {
+            return false;
+        }
+        pcb->status.store(new_status, memory_order_release);
+        logger().info("process_table", "[PROCESS TABLE] PID {} status: {}", pid, processStateName(new_status));
+        return true;
+    }
+
+    bool setWaitingTime(int pid, int wtime) {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (pcb) {
+            pcb->waiting_time.store(wtime, memory_order_relaxed);
+        }
+        return pcb != nullptr;
+    }
+
+    bool setTurnaroundTime(int pid, int ttime) {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (pcb) {
+            pcb->turnaround_time.store(ttime, memory_order_relaxed);
+        }
+        return pcb != nullptr;
+    }
+
+    bool setAffinity(int pid, uint64_t mask) {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (pcb) {
+            pcb->affinity_mask.store(mask, memory_order_relaxed);
+        }
+        return pcb != nullptr;
+    }
+
+    uint64_t getAffinity(int pid) const {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        return pcb ? pcb->affinity_mask.load(memory_order_relaxed) : 0;
+    }
+
+    // Page tables are installed and read by VirtualMemory, which runs on one
+    // thread, so they are not atomic. Passing nullptr removes the table.
+    bool setPageTable(int pid, shared_ptr<PageTable> table) {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (pcb) {
+            pcb->page_table = move(table);
+        }
+        return pcb != nullptr;
+    }
+
+    PageTable* pageTable(int pid) const {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        return pcb ? pcb->page_table.get() : nullptr;
+    }
+
+    ProcessState getStatus(int pid) const {
+        ProcessControlBlock* pcb = liveSlot(pid);
+        return pcb ? pcb->status.load(memory_order_acquire) : ProcessState::COMPLETED;
+    }
+
+    // Free the slot; its PID is handed to a later createProcess
+    bool releaseProcess(int pid) {
+        lock_guard<mutex> lock(timedLock(table_mutex, Metric::LOCK_PROCESS_TABLE), adopt_lock);
+        ProcessControlBlock* pcb = liveSlot(pid);
+        if (!pcb) {
+            return false;
+        }
+        pcb->in_use.store(false, memory_order_release);
+        pcb->page_table.reset();
+        free_pids.push_back(pid);
+        return true;
+    }
+
+    Snapshot snapshot() const {
+        return Snapshot(this, next_pid.load(memory_order_acquire));
+    }
+
+    size_t liveCount() {
+        lock_guard<mutex> lock(table_mutex);
+        return (size_t)next_pid.load(memory_order_relaxed) - 1 - free_pids.size();
+    }
+    
+    void displayProcessTable() {
+        logger().flush();
+        lock_guard<mutex> lock(table_mutex); // Keeps slots from being reused while printing
+        cout << "\n=== PROCESS TABLE ===" << endl;
+        cout << setw(6) << "PID" << setw(15) << "Transaction" << setw(12) << "Status" 
+             << setw(10) << "Wait Time" << endl;
+        cout << string(50, '-') << endl;
+        for (const ProcessControlBlock& pcb : snapshot()) {
+            cout << setw(6) << pcb.pid << setw(15) << pcb.transaction_id 
+                 << setw(12) << processStateName(pcb.status.load(memory_order_acquire))
+                 << setw(10) << pcb.waiting_time.load(memory_order_relaxed) << endl;
+        }
+    }
+};
+
+// --- Account File ---
+// accounts.dat is an AccountFileHeader followed by an open-addressing hash
+// table of fixed-size AccountRecords (linear probing, power-of-two capacity,
+// at most half full). Opening it maps the file and checks the header, so
+// startup time does not depend on the number of accounts, and lookups probe
+// the mapping directly. The file is never modified in place: a checkpoint
+// writes a new table beside it and renames it over the old one.
+struct AccountRecord {
+    static const size_t MAX_ID = 23;
+
+    char account_id[MAX_ID + 1];     // NUL-padded; an empty id marks a free slot
+    int64_t balance_cents;
+
+    size_t idLength() const {
+        size_t length = 0;
+        while (length < MAX_ID && account_id[length] != '\0') {
+            length++;
+        }
+        return length;
+    }
+};
+
+struct AccountFileHeader {
+    char magic[8];                   // "OSACCT01"
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t capacity;               // Table slots, a power of two
+    uint64_t count;                  // Occupied slots
+    int64_t checkpoint_lsn;          // Last WAL record folded into the table
+    char padding[24];
+};
+
+static_assert(sizeof(AccountRecord) == 32 && sizeof(AccountFileHeader) == 64, "account layout is part of the file format");
+static_assert(sizeof(atomic<long long>) == sizeof(int64_t), "mapped balances are updated in place as atomics");
+
+class AccountFile {
+private:
+    static constexpr char MAGIC[9] = "OSACCT01";
+    static constexpr uint64_t MIN_CAPACITY = 1024;
+
+    char* data = nullptr;
+    size_t data_size = 0;
+#ifdef _WIN32
+    vector<char> buffer;             // No mmap: the table is read into memory
+#endif
+    AccountRecord* records = nullptr;
+    uint64_t slot_mask = 0;
+    uint64_t record_count = 0;
+    long long checkpoint_lsn = 0;
+
+    static uint64_t hashId(const char* id, size_t length) {
+        uint64_t hash = 14695981039346656037ULL; // FNV-1a
+        for (size_t i = 0; i < length; i++) {
+            hash = (hash ^ (unsigned char)id[i]) * 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    // Slot holding id, or the free slot where it would be inserted. Returns
+    // mask + 1 if neither exists, which only a damaged file can cause.
+    static uint64_t probe(const AccountRecord* table, uint64_t mask, const char* id, size_t length) {
+        uint64_t slot = hashId(id, length) & mask;
+        for (uint64_t step = 0; step <= mask; step++) {
+            if (table[slot].account_id[0] == '\0'
+                || (memcmp(table[slot].account_id, id, length) == 0 && table[slot].account_id[length] == '\0')) {
+                return slot;
+            }
+            slot = (slot + 1) & mask;
+        }
+        return mask + 1;
+    }
+
+public:
+    AccountFile() {}
+    ~AccountFile() {
+        close();
+    }
+
+    AccountFile(const AccountFile&) = delete;
+    AccountFile& operator=(const AccountFile&) = delete;
+
+    static bool validId(const string& account_id) {
+        return !account_id.empty() && account_id.size() <= AccountRecord::MAX_ID;
+    }
+
+    // With writable = true the mapping is private copy-on-write: balances can
+    // be updated in place, but the changes never reach the file
+    bool open(const string& path, bool writable) {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(AccountFileHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = (size_t)info.st_size;
+        void* mapping = mmap(nullptr, size, PROT_READ | (writable ? PROT_WRITE : 0), MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        data = static_cast<char*>(mapping);
+        data_size = size;
+#else
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) {
+            return false;
+        }
+        buffer.resize((size_t)in.tellg());
+        in.seekg(0);
+        in.read(buffer.data(), buffer.size());
+        data = buffer.data();
+        data_size = buffer.size();
+#endif
+        const AccountFileHeader* header = reinterpret_cast<const AccountFileHeader*>(data);
+        if (data_size < sizeof(AccountFileHeader) || memcmp(header->magic, MAGIC, 8) != 0
+            || header->record_size != sizeof(AccountRecord) || header->capacity == 0
+            || (header->capacity & (header->capacity - 1)) != 0 || header->count >= header->capacity
+            || (data_size - sizeof(AccountFileHeader)) / sizeof(AccountRecord) < header->capacity) {
+            close();
+            return false;
+        }
+        records = reinterpret_cast<AccountRecord*>(data + sizeof(AccountFileHeader));
+        slot_mask = header->capacity - 1;
+        record_count = header->count;
+        checkpoint_lsn = header->checkpoint_lsn;
+        return true;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (data) {
+            munmap(data, data_size);
+        }
+#else
+        buffer.clear();
+        buffer.shrink_to_fit();
+#endif
+        data = nullptr;
+        data_size = 0;
+        records = nullptr;
+        slot_mask = 0;
+        record_count = 0;
+        checkpoint_lsn = 0;
+    }
+
+    bool isOpen() const {
+        return records != nullptr;
+    }
+
+    uint64_t count() const {
+        return record_count;
+    }
+
+    uint64_t capacity() const {
+        return records ? slot_mask + 1 : 0;
+    }
+
+    long long checkpointLsn() const {
+        return checkpoint_lsn;
+    }
+
+    AccountRecord* find(const string& account_id) const {
+        if (!records || !validId(account_id)) {
+            return nullptr;
+        }
+        uint64_t slot = probe(records, slot_mask, account_id.data(), account_id.size());
+        if (slot > slot_mask) {
+            return nullptr;
+        }
+        return records[slot].account_id[0] != '\0' ? &records[slot] : nullptr;
+    }
+
+    // Write base's accounts with changes applied (cents added per account;
+    // unknown accounts are created) as a new table at path. base may be
+    // closed, standing for an empty table.
+    static bool write(const string& path, const AccountFile& base, const map<string, long long>& changes, long long lsn) {
+        uint64_t count = base.count();
+        for (const auto& change : changes) {
+            if (validId(change.first) && !base.find(change.first)) {
+                count++;
+            }
+        }
+        uint64_t capacity = max(MIN_CAPACITY, base.capacity());
+        while (capacity < 2 * count + 1) {
+            capacity *= 2;
+        }
+
+        uint64_t mask = capacity - 1;
+        vector<AccountRecord> table(capacity);
+        if (capacity == base.capacity()) {
+            memcpy(table.data(), base.records, capacity * sizeof(AccountRecord));
+        } else {
+            for (uint64_t i = 0; base.records && i <= base.slot_mask; i++) {
+                const AccountRecord& record = base.records[i];
+                if (record.account_id[0] != '\0') {
+                    uint64_t slot = probe(table.data(), mask, record.account_id, record.idLength());
+                    if (slot > mask) {
+                        return false; // More records than the header counts
+                    }
+                    table[slot] = record;
+                }
+            }
+        }
+        for (const auto& change : changes) {
+            if (!validId(change.first)) {
+                continue;
+            }
+            uint64_t index = probe(table.data(), mask, change.first.data(), change.first.size());
+            if (index > mask) {
+                return false;
+            }
+            AccountRecord& slot = table[index];
+            if (slot.account_id[0] == '\0') {
+                memcpy(slot.account_id, change.first.data(), change.first.size());
+            }
+            slot.balance_cents += change.second;
+        }
+
+        AccountFileHeader header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(AccountRecord);
+        header.capacity = capacity;
+        header.count = count;
+        header.checkpoint_lsn = lsn;
+
+        string tmp_path = path + ".tmp";
+        FILE* out = fopen(tmp_path.c_str(), "wb");
+        if (!out) {
+            return false;
+        }
+        bool written = fwrite(&header, sizeof(header), 1, out) == 1
+                    && fwrite(table.data(), sizeof(AccountRecord), capacity, out) == capacity;
+        syncFile(out);
+        fclose(out);
+        error_code error;
+        if (written) {
+            filesystem::rename(tmp_path, path, error);
+        }
+        if (!written || error) {
+            filesystem::remove(tmp_path, error);
+            return false;
+        }
+        return true;
+    }
+
+    // One-time conversion of the text snapshot used by older builds: "ID
+    // balance" lines plus an optional "# checkpoint_lsn N" line
+    static bool importText(const string& text_path, const string& path, uint64_t& imported, uint64_t& skipped) {
+        ifstream in(text_path);
+        if (!in) {
+            return false;
+        }
+        map<string, long long> accounts;
+        long long lsn = 0;
+        string line;
+        while (getline(in, line)) {
+            if (line.empty()) {
+                continue;
+            }
+            if (line[0] == '#') {
+                sscanf(line.c_str(), "# checkpoint_lsn %lld", &lsn);
+                continue;
+            }
+            istringstream fields(line);
+            string account_id, balance;
+            long long cents;
+            if ((fields >> account_id >> balance) && parseCents(balance, cents) && validId(account_id)) {
+                accounts[account_id] = cents;
+            } else {
+                skipped++;
+            }
+        }
+        imported = accounts.size();
+        AccountFile empty;
+        return write(path, empty, accounts, lsn);
+    }
+};
+
+constexpr char AccountFile::MAGIC[9];
+
+// --- Write-Ahead Log ---
+// Balance changes are appended to accounts.wal as delta records instead of
+// rewriting accounts.dat on every transaction. Concurrent committers share one
+// fsync (group commit), and accounts.dat is only rewritten at checkpoints.
+class WriteAheadLog {
+private:
+    struct WalRecord {
+        long long lsn;
+        char op; // 'C' = create account, 'D' = balance delta, 'M' = multi-account
+        string account_id;
+        long long cents;
+        vector<pair<string, long long>> legs; // 'M' only: every delta of one transaction
+    };
+
+    const string snapshot_path;
+    const string log_path;
+    const size_t CHECKPOINT_INTERVAL = 4096; // Records between checkpoints
+
+    FILE* log_file;
+    mutex wal_mutex;
+    condition_variable flushed_cv;
+    string pending;                  // Serialized records awaiting flush
+    vector<WalRecord> pending_records;
+    long long next_lsn;
+    long long durable_lsn;
+    bool flush_in_progress;
+
+    // Owned by the flush leader: the last checkpoint plus the net change per
+    // account since then together give the account state as of durable_lsn
+    AccountFile snapshot;
+    map<string, long long> checkpoint_changes;
+    size_t records_since_checkpoint;
+    bool checkpoints_disabled;       // accounts.dat is damaged and must not be overwritten
+    atomic<bool> log_failed{false};  // The log cannot be written; nothing more is durable
+
+    static unsigned int checksum(const string& body) {
+        unsigned int hash = 2166136261u; // FNV-1a
+        for (unsigned char c : body) {
+            hash = (hash ^ c) * 16777619u;
+        }
+        return hash;
+    }
+
+    static string formatRecord(const WalRecord& record) {
+        string body = to_string(record.lsn) + " " + record.op + " ";
+        if (record.op == 'M') {
+            body += to_string(record.legs.size());
+            for (const auto& leg : record.legs) {
+                body += " " + leg.first + " " + formatCents(leg.second);
+            }
+        } else {
+            body += record.account_id + " " + formatCents(record.cents);
+        }
+        char tail[16];
+        snprintf(tail, sizeof(tail), " *%08x\n", checksum(body));
+        return body + tail;
+    }
+
+    // Returns false for torn or corrupted records
+    static bool parseRecord(const string& line, WalRecord& record) {
+        size_t mark = line.rfind(" *");
+        if (mark == string::npos) {
+            return false;
+        }
+        string body = line.substr(0, mark);
+        unsigned int expected;
+        if (sscanf(line.c_str() + mark + 2, "%x", &expected) != 1 || expected != checksum(body)) {
+            return false;
+        }
+        istringstream fields(body);
+        string amount;
+        if (!(fields >> record.lsn >> record.op)) {
+            return false;
+        }
+        if (record.op != 'M') {
+            return (fields >> record.account_id >> amount) && parseCents(amount, record.cents);
+        }
+        size_t count;
+        if (!(fields >> count)) {
+            return false;
+        }
+        for (size_t i = 0; i < count; i++) {
+            string account_id;
+            long long cents;
+            if (!(fields >> account_id >> amount) || !parseCents(amount, cents)) {
+                return false;
+            }
+            record.legs.push_back({account_id, cents});
+        }
+        return true;
+    }
+
+    // Every record kind is additive (an account starts at zero), so records
+    // appended concurrently from different shards replay to the same state
+    // regardless of their relative LSN order
+    static void applyRecord(map<string, long long>& image, const WalRecord& record) {
+        if (record.op == 'M') {
+            for (const auto& leg : record.legs) {
+                image[leg.first] += leg.second;
+            }
+        } else {
+            image[record.account_id] += record.cents;
+        }
+    }
+
+    // Write the next accounts.dat atomically, then start an empty log
+    bool writeCheckpoint(long long lsn) {
+        if (checkpoints_disabled) {
+            return false; // The log keeps every record instead
+        }
+        if (!AccountFile::write(snapshot_path, snapshot, checkpoint_changes, lsn)) {
+            logger().error("wal", "[WAL] Checkpoint failed: cannot write {}", snapshot_path);
+            return false;
+        }
+        if (!snapshot.open(snapshot_path, false)) {
+            logger().error("wal", "[WAL] Checkpoint failed: cannot map {}", snapshot_path);
+            return false;
+        }
+        checkpoint_changes.clear();
+
+        // Records up to lsn now live in the snapshot
+        if (log_file) {
+            fclose(log_file);
+        }
+        log_file = fopen(log_path.c_str(), "wb");
+        if (!log_file) {
+            failLog("cannot reopen");
+        }
+        records_since_checkpoint = 0;
+        return true;
+    }
+
+    void failLog(const char* reason) {
+        if (!log_failed.exchange(true)) {
+            logger().error("wal", "[WAL] {}: {}; further transactions are refused", log_path, reason);
+        }
+    }
+
+    // Rewriting the table costs O(accounts), so checkpoints are spaced out as
+    // the table grows to keep the cost per logged record constant
+    size_t checkpointInterval() const {
+        return max(CHECKPOINT_INTERVAL, (size_t)(snapshot.count() / 4));
+    }
+
+public:
+    WriteAheadLog(const string& snapshot, const string& log)
+        : snapshot_path(snapshot), log_path(log), log_file(nullptr), next_lsn(1),
+          durable_lsn(0), flush_in_progress(false), records_since_checkpoint(0),
+          checkpoints_disabled(false) {}
+
+    ~WriteAheadLog() {
+        commit(next_lsn - 1);
+        if (records_since_checkpoint > 0) {
+            writeCheckpoint(durable_lsn);
+        }
+        if (log_file) {
+            fclose(log_file);
+        }
+    }
+
+    // Map the last checkpoint and fold every later record in the log into a
+    // new one. Returns the changes that could not be checkpointed, which the
+    // caller must apply on top of accounts.dat (normally none).
+    map<string, long long> recover() {
+        checkpoint_changes.clear();
+        long long checkpoint_lsn = 0;
+        if (snapshot.open(snapshot_path, false)) {
+            checkpoint_lsn = snapshot.checkpointLsn();
+        } else if (filesystem::exists(snapshot_path)) {
+            // Keep the damaged table for inspection; otherwise the next
+            // checkpoint would replace it with what the log alone rebuilds
+            string damaged_path = snapshot_path + ".damaged";
+            for (int n = 1; filesystem::exists(damaged_path); n++) {
+                damaged_path = snapshot_path + ".damaged." + to_string(n);
+            }
+            error_code error;
+            filesystem::rename(snapshot_path, damaged_path, error);
+            if (error) {
+                checkpoints_disabled = true;
+                logger().error("wal", "[WAL] {} is not a valid account file and cannot be moved aside; checkpoints disabled", snapshot_path);
+            } else {
+                logger().error("wal", "[WAL] {} is not a valid account file; moved to {}", snapshot_path, damaged_path);
+            }
+        }
+
+        long long last_lsn = checkpoint_lsn;
+        size_t replayed = 0;
+        bool log_present = false;
+        uintmax_t valid_bytes = 0;       // End of the last complete record
+        string line;
+        ifstream log(log_path, ios::binary);
+        while (getline(log, line)) {
+            log_present = true;
+            WalRecord record;
+            if (log.eof() || !parseRecord(line, record)) { // Every record ends in '\n'
+                logger().warn("wal", "[WAL] Ignoring torn record after LSN {}", last_lsn);
+                break;
+            }
+            valid_bytes += line.size() + 1;
+            if (record.lsn <= checkpoint_lsn) {
+                continue; // Already folded into the snapshot
+            }
+            applyRecord(checkpoint_changes, record);
+            last_lsn = record.lsn;
+            replayed++;
+        }
+        log.close();
+
+        // Cut off a torn tail, or records appended after it would be lost at
+        // the next recovery, which stops at the tear
+        error_code error;
+        if (log_present && filesystem::file_size(log_path, error) > valid_bytes && !error) {
+            filesystem::resize_file(log_path, valid_bytes, error);
+            if (error) {
+                failLog("cannot truncate the torn tail");
+            }
+        }
+
+        if (replayed > 0) {
+            logger().info("wal", "[WAL] Replayed {} log records", replayed);
+        }
+        next_lsn = last_lsn + 1;
+        durable_lsn = last_lsn;
+
+        // Fold the replayed records into a fresh snapshot so new appends never
+        // land behind a torn tail
+        if (!log_failed && (!log_present || !writeCheckpoint(last_lsn))) {
+            log_file = fopen(log_path.c_str(), "ab");
+            if (!log_file) {
+                failLog("cannot open for append");
+            }
+        }
+        return checkpoint_changes;
+    }
+
+    // Queue a record in memory and return its LSN; call commit() to make it durable
+    long long append(char op, const string& account_id, long long cents) {
+        lock_guard<mutex> lock(timedLock(wal_mutex, Metric::LOCK_WAL), adopt_lock);
+        WalRecord record{next_lsn++, op, account_id, cents, {}};
+        pending += formatRecord(record);
+        pending_records.push_back(move(record));
+        return pending_records.back().lsn;
+    }
+
+    // One record for all deltas of a multi-account transaction, so a torn
+    // tail drops the whole transaction rather than some of its legs
+    long long appendLegs(const vector<pair<string, long long>>& legs) {
+        lock_guard<mutex> lock(timedLock(wal_mutex, Metric::LOCK_WAL), adopt_lock);
+        WalRecord record{next_lsn++, 'M', "", 0, legs};
+        pending += formatRecord(record);
+        pending_records.push_back(move(record));
+        return pending_records.back().lsn;
+    }
+
+    // Block until lsn is on stable storage. The first waiter becomes the flush
+    // leader and writes every queued record with a single fsync; the others
+    // wait for it and are usually covered by the same batch. Returns false
+    // once the log cannot be written; durable_lsn then stops advancing.
+    bool commit(long long lsn) {
+        unique_lock<mutex> lock(timedLock(wal_mutex, Metric::LOCK_WAL), adopt_lock);
+        while (durable_lsn < lsn) {
+            if (log_failed) {
+                return false;
+            }
+            if (flush_in_progress) {
+                flushed_cv.wait(lock);
+                continue;
+            }
+            flush_in_progress = true;
+            string batch;
+            vector<WalRecord> batch_records;
+            batch.swap(pending);
+            batch_records.swap(pending_records);
+            long long batch_lsn = next_lsn - 1;
+            lock.unlock();
+
+            bool written = log_file && fwrite(batch.data(), 1, batch.size(), log_file) == batch.size()
+                           && syncFile(log_file);
+            if (!written) {
+                failLog("write failed");
+            } else {
+                for (const auto& record : batch_records) {
+                    applyRecord(checkpoint_changes, record);
+                }
+                records_since_checkpoint += batch_records.size();
+                if (records_since_checkpoint >= checkpointInterval()) {
+                    writeCheckpoint(batch_lsn);
+                }
+            }
+
+            lock.lock();
+            if (written) {
+                durable_lsn = batch_lsn;
+            }
+            flush_in_progress = false;
+            flushed_cv.notify_all();
+        }
+        return true;
+    }
+
+    bool failed() const {
+        return log_failed.load(memory_order_acquire);
+    }
+
+    // Make every record appended so far durable
+    bool flush() {
+        long long lsn;
+        {
+            lock_guard<mutex> lock(wal_mutex);
+            lsn = next_lsn - 1;
+        }
+        return commit(lsn);
+    }
+};
+
+// --- Sharded Account Store ---
+// Accounts from the last checkpoint are looked up in the mapped accounts.dat
+// table, whose layout never changes while it is open, so no lock is needed.
+// Accounts created since then are spread over independently locked hash
+// shards; the shard lock only guards the index. Balances are atomic cents, so
+// transactions on different accounts never serialize on a common lock.
+class AccountStore {
+public:
+    struct Account {
+        atomic<long long> balance_cents;
+        explicit Account(long long cents) : balance_cents(cents) {}
+    };
+
+private:
+    static const size_t SHARD_COUNT = 64;
+
+    AccountFile snapshot; // Copy-on-write mapping; live balances never reach the file
+
+    struct alignas(64) Shard {
+        shared_mutex shard_mutex;
+        unordered_map<string, unique_ptr<Account>> accounts;
+    };
+
+    Shard shards[SHARD_COUNT];
+
+    Shard& shardFor(const string& account_id) {
+        return shards[hash<string>{}(account_id) % SHARD_COUNT];
+    }
+
+    static atomic<long long>* balanceOf(AccountRecord* record) {
+        return reinterpret_cast<atomic<long long>*>(&record->balance_cents);
+    }
+
+public:
+    // Map the checkpointed accounts; a missing file means none
+    bool open(const string& path) {
+        return snapshot.open(path, true);
+    }
+
+    uint64_t mappedCount() const {
+        return snapshot.count();
+    }
+
+    // Neither mapped records nor Account objects are freed while the store is
+    // open, so the balance stays valid after the shard lock is released
+    atomic<long long>* find(const string& account_id) {
+        if (AccountRecord* record = snapshot.find(account_id)) {
+            return balanceOf(record);
+        }
+        Shard& shard = shardFor(account_id);
+        shared_lock<shared_mutex> lock(shard.shard_mutex);
+        auto it = shard.accounts.find(account_id);
+        return it == shard.accounts.end() ? nullptr : &it->second->balance_cents;
+    }
+
+    // Returns nullptr if the account already exists
+    atomic<long long>* insert(const string& account_id, long long cents) {
+        if (snapshot.find(account_id)) {
+            return nullptr;
+        }
+        Shard& shard = shardFor(account_id);
+        unique_lock<shared_mutex> lock(timedLock(shard.shard_mutex, Metric::LOCK_ACCOUNT_SHARD), adopt_lock);
+        auto& slot = shard.accounts[account_id];
+        if (slot) {
+            return nullptr;
+        }
+        slot = make_unique<Account>(cents);
+        return &slot->balance_cents;
+    }
+
+    void clear() {
+        snapshot.close();
+        for (auto& shard : shards) {
+            unique_lock<shared_mutex> lock(shard.shard_mutex);
+            shard.accounts.clear();
+        }
+    }
+};
+
+// --- Account Management ---
+enum class AccountStatus { OK, NOT_FOUND, INSUFFICIENT_FUNDS, ALREADY_EXISTS, INVALID_ID, INVALID_AMOUNT, LOG_FAILED };
+
+class AccountManager {
+private:
+    static const size_t LOCK_STRIPES = 1024;
+
+    struct alignas(64) LockStripe {
+        mutex stripe_mutex;
+    };
+
+    AccountStore accounts;
+    const string ACCOUNT_FILE;
+    const string WAL_FILE;
+    WriteAheadLog wal;
+    LockStripe account_locks[LOCK_STRIPES];
+
+    // A balance change and its log record happen under the account's stripe,
+    // so the log order of an account matches the order its changes became visible
+    mutex& accountLock(const string& account_id) {
+        return account_locks[hash<string>{}(account_id) % LOCK_STRIPES].stripe_mutex;
+    }
+
+    static bool tryDebit(atomic<long long>* balance, long long cents) {
+        long long current = balance->load(memory_order_acquire);
+        do {
+            if (current < cents) {
+                return false;
+            }
+        } while (!balance->compare_exchange_weak(current, current - cents, memory_order_acq_rel));
+        return true;
+    }
+
+    // Helper function to load accounts: last checkpoint plus log replay
+    void loadAccountsFromFile() {
+        accounts.clear();
+        string legacy_file = filesystem::path(ACCOUNT_FILE).replace_extension(".txt").string();
+        if (legacy_file != ACCOUNT_FILE && !filesystem::exists(ACCOUNT_FILE) && filesystem::exists(legacy_file)) {
+            uint64_t imported = 0, skipped = 0;
+            if (AccountFile::importText(legacy_file, ACCOUNT_FILE, imported, skipped)) {
+                logger().info("accounts", "Imported {} accounts from {} ({} lines skipped)", imported, legacy_file, skipped);
+            } else {
+                logger().error("accounts", "Cannot import {} into {}", legacy_file, ACCOUNT_FILE);
+            }
+        }
+
+        map<string, long long> unfolded = wal.recover();
+        accounts.open(ACCOUNT_FILE);
+        for (const auto& entry : unfolded) {
+            if (atomic<long long>* balance = accounts.find(entry.first)) {
+                balance->fetch_add(entry.second, memory_order_relaxed);
+            } else {
+                accounts.insert(entry.first, entry.second);
+            }
+        }
+    }
+
+public:
+    explicit AccountManager(const string& account_file = "accounts.dat", const string& wal_file = "accounts.wal")
+        : ACCOUNT_FILE(account_file), WAL_FILE(wal_file), wal(ACCOUNT_FILE, WAL_FILE) {
+        loadAccountsFromFile(); // Load accounts when the system starts
+    }
+
+    // Quiet cents-based operations. With durable = false the log record is
+    // only queued; a later flushLog() commits the whole batch with one fsync.
+    // Once the log cannot be written, changes are refused with LOG_FAILED; a
+    // durable change whose commit fails also reports LOG_FAILED and is lost
+    // at the next restart.
+    AccountStatus createAccountCents(const string& account_id, long long cents, bool durable = true) {
+        if (!AccountFile::validId(account_id)) {
+            return AccountStatus::INVALID_ID;
+        }
+        if (cents < 0) {
+            return AccountStatus::INVALID_AMOUNT;
+        }
+        if (wal.failed()) {
+            return AccountStatus::LOG_FAILED;
+        }
+        long long lsn;
+        {
+            lock_guard<mutex> lock(timedLock(accountLock(account_id), Metric::LOCK_ACCOUNT_STRIPE), adopt_lock);
+            if (!accounts.insert(account_id, cents)) {
+                return AccountStatus::ALREADY_EXISTS;
+            }
+            lsn = wal.append('C', account_id, cents);
+        }
+        if (durable && !wal.commit(lsn)) {
+            return AccountStatus::LOG_FAILED;
+        }
+        return AccountStatus::OK;
+    }
+
+    AccountStatus depositCents(const string& account_id, long long cents, bool durable = true) {
+        if (cents <= 0) {
+            return AccountStatus::INVALID_AMOUNT;
+        }
+        if (wal.failed()) {
+            return AccountStatus::LOG_FAILED;
+        }
+        atomic<long long>* balance = accounts.find(account_id);
+        if (!balance) {
+            return AccountStatus::NOT_FOUND;
+        }
+        long long lsn;
+        {
+            lock_guard<mutex> lock(timedLock(accountLock(account_id), Metric::LOCK_ACCOUNT_STRIPE), adopt_lock);
+            balance->fetch_add(cents, memory_order_acq_rel);
+            lsn = wal.append('D', account_id, cents);
+        }
+        if (durable && !wal.commit(lsn)) { // Group commit
+            return AccountStatus::LOG_FAILED;
+        }
+        return AccountStatus::OK;
+    }
+
+    AccountStatus withdrawCents(const string& account_id, long long cents, bool durable = true) {
+        if (cents <= 0) {
+            return AccountStatus::INVALID_AMOUNT;
+        }
+        if (wal.failed()) {
+            return AccountStatus::LOG_FAILED;
+        }
+        atomic<long long>* balance = accounts.find(account_id);
+        if (!balance) {
+            return AccountStatus::NOT_FOUND;
+        }
+        long long lsn;
+        {
+            lock_guard<mutex> lock(timedLock(accountLock(account_id), Metric::LOCK_ACCOUNT_STRIPE), adopt_lock);
+            if (!tryDebit(balance, cents)) {
+                return AccountStatus::INSUFFICIENT_FUNDS;
+            }
+            lsn = wal.append('D', account_id, -cents);
+        }
+        if (durable && !wal.commit(lsn)) { // Group commit
+            return AccountStatus::LOG_FAILED;
+        }
+        return AccountStatus::OK;
+    }
+
+    AccountStatus balanceCents(const string& account_id, long long& cents) {
+        atomic<long long>* balance = accounts.find(account_id);
+        if (!balance) {
+            return AccountStatus::NOT_FOUND;
+        }
+        lock_guard<mutex> lock(timedLock(accountLock(account_id), Metric::LOCK_ACCOUNT_STRIPE), adopt_lock);
+        cents = balance->load(memory_order_acquire);
+        return AccountStatus::OK;
+    }
+
+    // Multi-account transaction: each leg adds cents to one account (negative
+    // legs debit). Either every leg applies or none does, and the legs reach
+    // the log as one record. The lock stripes of all touched accounts are
+    // taken in ascending order, so overlapping transactions serialize without
+    // deadlock while disjoint ones run in parallel. Single-account operations
+    // and balance reads take the same stripes, so no reader sees part of a
+    // transaction.
+    AccountStatus applyLegsCents(vector<pair<string, long long>> legs, bool durable = true) {
+        // Merge legs on the same account so each balance is touched once
+        sort(legs.begin(), legs.end());
+        size_t merged = 0;
+        for (size_t i = 0; i < legs.size(); i++) {
+            if (merged > 0 && legs[merged - 1].first == legs[i].first) {
+                legs[merged - 1].second += legs[i].second;
+            } else {
+                legs[merged++] = legs[i];
+            }
+        }
+        legs.resize(merged);
+        if (wal.failed()) {
+            return AccountStatus::LOG_FAILED;
+        }
+
+        vector<atomic<long long>*> balances;
+        vector<size_t> stripes;
+        for (const auto& leg : legs) {
+            atomic<long long>* balance = accounts.find(leg.first);
+            if (!balance) {
+                return AccountStatus::NOT_FOUND;
+            }
+            balances.push_back(balance);
+            stripes.push_back(hash<string>{}(leg.first) % LOCK_STRIPES);
+        }
+        sort(stripes.begin(), stripes.end());
+        stripes.erase(unique(stripes.begin(), stripes.end()), stripes.end());
+
+        long long lsn;
+        {
+            vector<unique_lock<mutex>> held;
+            held.reserve(stripes.size());
+            for (size_t stripe : stripes) {
+                held.emplace_back(timedLock(account_locks[stripe].stripe_mutex, Metric::LOCK_ACCOUNT_STRIPE), adopt_lock);
+            }
+            // Every balance is stable under the stripes, so check all debits
+            // before changing anything; a refused batch is never half-applied
+            for (size_t i = 0; i < legs.size(); i++) {
+                if (legs[i].second < 0 && balances[i]->load(memory_order_acquire) < -legs[i].second) {
+                    return AccountStatus::INSUFFICIENT_FUNDS;
+                }
+            }
+            for (size_t i = 0; i < legs.size(); i++) {
+                balances[i]->fetch_add(legs[i].second, memory_order_acq_rel);
+            }
+            lsn = wal.appendLegs(legs);
+        }
+        if (durable && !wal.commit(lsn)) { // Group commit
+            return AccountStatus::LOG_FAILED;
+        }
+        return AccountStatus::OK;
+    }
+
+    AccountStatus transferCents(const string& from_id, const string& to_id, long long cents, bool durable = true) {
+        if (cents <= 0) {
+            return AccountStatus::INVALID_AMOUNT;
+        }
+        return applyLegsCents({{from_id, -cents}, {to_id, cents}}, durable);
+    }
+
+    bool flushLog() {
+        return wal.flush();
+    }
+
+    bool createAccount(const string& account_id, double initial_balance) {
+        AccountStatus status = createAccountCents(account_id, toCents(initial_balance));
+        if (status == AccountStatus::INVALID_ID) {
+            logger().warn("accounts", "Account ID must be 1-{} characters!", (int)AccountRecord::MAX_ID);
+            return false;
+        }
+        if (status == AccountStatus::INVALID_AMOUNT) {
+            logger().warn("accounts", "Initial balance cannot be negative!");
+            return false;
+        }
+        if (status == AccountStatus::LOG_FAILED) {
+            logger().error("accounts", "Transaction log unavailable; account {} not created", account_id);
+            return false;
+        }
+        if (status != AccountStatus::OK) {
+            logger().warn("accounts", "Account ID already exists!");
+            return false;
+        }
+        logger().info("accounts", "Account created for {} with balance: {}", account_id, initial_balance);
+        return true;
+    }
+
+    bool deposit(const string& account_id, double amount) {
+        AccountStatus status = depositCents(account_id, toCents(amount));
+        if (status == AccountStatus::INVALID_AMOUNT) {
+            logger().warn("accounts", "Deposit amount must be positive!");
+            return false;
+        }
+        if (status == AccountStatus::LOG_FAILED) {
+            logger().error("accounts", "Transaction log unavailable; deposit to {} not recorded", account_id);
+            return false;
+        }
+        if (status != AccountStatus::OK) {
+            logger().warn("accounts", "Account {} not found!", account_id);
+            return false;
+        }
+        logger().info("accounts", "Deposited {} to account {}", amount, account_id);
+        return true;
+    }
+
+    bool withdraw(const string& account_id, double amount) {
+        AccountStatus status = withdrawCents(account_id, toCents(amount));
+        if (status == AccountStatus::INVALID_AMOUNT) {
+            logger().warn("accounts", "Withdrawal amount must be positive!");
+            return false;
+        }
+        if (status == AccountStatus::LOG_FAILED) {
+            logger().error("accounts", "Transaction log unavailable; withdrawal from {} not recorded", account_id);
+            return false;
+        }
+        if (status == AccountStatus::NOT_FOUND) {
+            logger().warn("accounts", "Account {} not found!", account_id);
+            return false;
+        }
+        if (status == AccountStatus::INSUFFICIENT_FUNDS) {
+            logger().warn("accounts", "Insufficient balance in account {}", account_id);
+            return false;
+        }
+        logger().info("accounts", "Withdrew {} from account {}", amount, account_id);
+        return true;
+    }
+
+    bool transfer(const string& from_id, const string& to_id, double amount) {
+        AccountStatus status = transferCents(from_id, to_id, toCents(amount));
+        if (status == AccountStatus::INVALID_AMOUNT) {
+            logger().warn("accounts", "Transfer amount must be positive!");
+            return false;
+        }
+        if (status == AccountStatus::LOG_FAILED) {
+            logger().error("accounts", "Transaction log unavailable; transfer from {} not recorded", from_id);
+            return false;
+        }
+        if (status == AccountStatus::NOT_FOUND) {
+            logger().warn("accounts", "Account {} or {} not found!", from_id, to_id);
+            return false;
+        }
+        if (status == AccountStatus::INSUFFICIENT_FUNDS) {
+            logger().warn("accounts", "Insufficient balance in account {}", from_id);
+            return false;
+        }
+        logger().info("accounts", "Transferred {} from account {} to account {}", amount, from_id, to_id);
+        return true;
+    }
+
+    bool checkBalance(const string& account_id) {
+        long long cents;
+        if (balanceCents(account_id, cents) != AccountStatus::OK) {
+            logger().warn("accounts", "Account {} not found!", account_id);
+            return false;
+        }
+        logger().info("accounts", "Balance for account {}: {}", account_id, formatCents(cents));
+        return true;
+    }
+};
+
+// --- Thread Pool ---
+// Persistent workers with one task deque each. A worker pops from the back of
+// its own deque and steals from the front of the others when it runs dry;
+// tasks submitted from a worker go to that worker's own deque.
+class ThreadPool {
+private:
+    struct alignas(64) WorkerQueue {
+        mutex queue_mutex;
+        deque<function<void()>> tasks;
+    };
+
+    vector<unique_ptr<WorkerQueue>> queues;
+    vector<thread> workers;
+    mutex sleep_mutex;
+    condition_variable wake_cv;
+    atomic<size_t> queued_tasks;
+    atomic<size_t> next_queue;
+    bool stopping;
+
+    static thread_local ThreadPool* current_pool;
+    static thread_local size_t current_index;
+
+    bool popLocal(size_t index, function<void()>& task) {
+        WorkerQueue& queue = *queues[index];
+        lock_guard<mutex> lock(queue.queue_mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        task = move(queue.tasks.back());
+        queue.tasks.pop_back();
+        return true;
+    }
+
+    bool steal(size_t thief, function<void()>& task) {
+        for (size_t i = 1; i < queues.size(); i++) {
+            WorkerQueue& victim = *queues[(thief + i) % queues.size()];
+            lock_guard<mutex> lock(victim.queue_mutex);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        current_pool = this;
+        current_index = index;
+        while (true) {
+            function<void()> task;
+            if (popLocal(index, task) || steal(index, task)) {
+                queued_tasks.fetch_sub(1, memory_order_acq_rel);
+                task();
+                continue;
+            }
+            unique_lock<mutex> lock(sleep_mutex);
+            wake_cv.wait(lock, [this] { return stopping || queued_tasks.load() > 0; });
+            if (stopping && queued_tasks.load() == 0) {
+                return;
+            }
+        }
+    }
+
+    void enqueue(function<void()> task) {
+        size_t index = (current_pool == this)
+                           ? current_index
+                           : next_queue.fetch_add(1, memory_order_relaxed) % queues.size();
+        {
+            lock_guard<mutex> lock(queues[index]->queue_mutex);
+            queues[index]->tasks.push_back(move(task));
+        }
+        queued_tasks.fetch_add(1, memory_order_acq_rel);
+        {
+            lock_guard<mutex> lock(sleep_mutex); // Pairs with the predicate check in workerLoop
+        }
+        wake_cv.notify_one();
+    }
+
+public:
+    explicit ThreadPool(size_t worker_count = 0)
+        : queued_tasks(0), next_queue(0), stopping(false) {
+        if (worker_count == 0) {
+            worker_count = max(1u, thread::hardware_concurrency());
+        }
+        for (size_t i = 0; i < worker_count; i++) {
+            queues.push_back(make_unique<WorkerQueue>());
+        }
+        for (size_t i = 0; i < worker_count; i++) {
+            workers.emplace_back(&ThreadPool::workerLoop, this, i);
+        }
+    }
+
+    // Finishes every queued task before the workers exit
+    ~ThreadPool() {
+        {
+            lock_guard<mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake_cv.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template <typename Fn>
+    auto submit(Fn&& fn) -> future<decltype(fn())> {
+        using Result = decltype(fn());
+        auto job = make_shared<packaged_task<Result()>>(forward<Fn>(fn));
+        future<Result> result = job->get_future();
+        enqueue([job] { (*job)(); });
+        return result;
+    }
+
+    size_t queuedTasks() const {
+        return queued_tasks.load(memory_order_acquire);
+    }
+
+    size_t size() const {
+        return workers.size();
+    }
+};
+
+thread_local ThreadPool* ThreadPool::current_pool = nullptr;
+thread_local size_t ThreadPool::current_index = 0;
+
+// --- Transaction Traces ---
+// Batch input for headless replay. Text traces hold one record per line:
+//     deposit ACC1 250.00
+//     withdraw ACC1 75.50
+//     balance ACC1
+//     create ACC2 1000
+//     transfer ACC1 ACC2 40.00
+// Binary traces are a TraceHeader followed by fixed-width TraceRecords, so a
+// mapped file is read in place with no parsing and no allocation. A transfer
+// takes two records: TRANSFER with the source and amount, then TRANSFER_TO
+// with the destination.
+enum class TraceOp : uint8_t { CREATE = 1, DEPOSIT = 2, WITHDRAW = 3, BALANCE = 4, TRANSFER = 5, TRANSFER_TO = 6 };
+
+struct TraceRecord {
+    static const size_t MAX_ID = AccountRecord::MAX_ID; // Any valid account fits
+
+    uint8_t op;
+    char account_id[MAX_ID];         // NUL-padded
+    int64_t amount_cents;
+
+    size_t idLength() const {
+        size_t length = 0;
+        while (length < MAX_ID && account_id[length] != '\0') {
+            length++;
+        }
+        return length;
+    }
+
+    string_view id() const {
+        return string_view(account_id, idLength());
+    }
+};
+
+struct TraceHeader {
+    char magic[8];                   // "OSTRACE1"
+    uint32_t record_size;
+    uint32_t reserved;
+    uint64_t record_count;
+};
+
+static_assert(sizeof(TraceRecord) == 32 && sizeof(TraceHeader) == 24, "trace layout is part of the file format");
+
+// Visits the first record_count fixed-size records that follow a TraceHeader.
+// The file is mapped and read in place where mmap exists, in chunks otherwise.
+template <typename Record, typename Visit>
+static bool forEachMappedRecord(const string& path, uint64_t record_count, Visit& visit) {
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+    size_t size = (size_t)info.st_size;
+    if (size < sizeof(TraceHeader)) {
+        close(fd);
+        return false;
+    }
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+    madvise(mapping, size, MADV_SEQUENTIAL);
+    const Record* records = reinterpret_cast<const Record*>(static_cast<const char*>(mapping) + sizeof(TraceHeader));
+    uint64_t available = (size - sizeof(TraceHeader)) / sizeof(Record);
+    uint64_t count = min(record_count, available);
+    for (uint64_t i = 0; i < count; i++) {
+        visit(records[i]);
+    }
+    munmap(mapping, size);
+    return true;
+#else
+    FILE* in = fopen(path.c_str(), "rb");
+    if (!in) {
+        return false;
+    }
+    fseek(in, sizeof(TraceHeader), SEEK_SET);
+    vector<Record> block((1 << 20) / sizeof(Record));
+    uint64_t remaining = record_count;
+    size_t got;
+    while (remaining > 0 && (got = fread(block.data(), sizeof(Record),
+                                         (size_t)min<uint64_t>(block.size(), remaining), in)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            visit(block[i]);
+        }
+        remaining -= got;
+    }
+    fclose(in);
+    return true;
+#endif
+}
+
+class TransactionTrace {
+public:
+    enum Format { TEXT, BINARY };
+
+private:
+    static constexpr char MAGIC[9] = "OSTRACE1";
+    static const size_t READ_CHUNK = 1 << 20;
+
+    string path;
+    Format trace_format = TEXT;
+    uint64_t record_count = 0;       // Known up front for binary traces only
+
+    static const char* skipSpaces(const char* p) {
+        while (*p == ' ' || *p == '\t' || *p == '\r') {
+            p++;
+        }
+        return p;
+    }
+
+    static const char* tokenEnd(const char* p) {
+        while (*p && *p != ' ' && *p != '\t' && *p != '\r') {
+            p++;
+        }
+        return p;
+    }
+
+    static bool tokenIs(const char* begin, const char* end, const char* word) {
+        size_t length = strlen(word);
+        return (size_t)(end - begin) == length && memcmp(begin, word, length) == 0;
+    }
+
+    template <typename Visit>
+    bool forEachBinary(Visit& visit) {
+        return forEachMappedRecord<TraceRecord>(path, record_count, visit);
+    }
+
+    // Lines are parsed in place inside a reusable chunk buffer
+    template <typename Visit>
+    bool forEachText(Visit& visit, uint64_t& malformed) {
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) {
+            return false;
+        }
+        vector<char> buffer(READ_CHUNK + 1);
+        size_t carried = 0;
+        bool skipping = false; // Inside a line longer than the buffer, already counted
+        while (true) {
+            size_t got = fread(buffer.data() + carried, 1, READ_CHUNK - carried, in);
+            size_t filled = carried + got;
+            bool at_end = got == 0;
+            if (filled == 0) {
+                break;
+            }
+            size_t line_start = 0;
+            for (size_t i = 0; i < filled; i++) {
+                if (buffer[i] != '\n') {
+                    continue;
+                }
+                buffer[i] = '\0';
+                if (!skipping) {
+                    parseLine(buffer.data() + line_start, visit, malformed);
+                }
+                skipping = false;
+                line_start = i + 1;
+            }
+            carried = filled - line_start;
+            if (skipping) {
+                carried = 0; // The overlong line goes on past this chunk
+                if (at_end) {
+                    break;
+                }
+                continue;
+            }
+            if (at_end) {
+                // Last line without a newline
+                buffer[carried] = '\0';
+                parseLine(buffer.data() + line_start, visit, malformed);
+                break;
+            }
+            if (line_start == 0 && carried == READ_CHUNK) {
+                // Never parse a fragment: its tail could look like a record
+                malformed++;
+                skipping = true;
+                carried = 0;
+                continue;
+            }
+            memmove(buffer.data(), buffer.data() + line_start, carried);
+        }
+        fclose(in);
+        return true;
+    }
+
+    template <typename Visit>
+    static void parseLine(const char* line, Visit& visit, uint64_t& malformed) {
+        const char* p = skipSpaces(line);
+        if (*p == '\0' || *p == '#') {
+            return;
+        }
+        TraceRecord records[2];
+        size_t count = parseTextRecord(p, records);
+        for (size_t i = 0; i < count; i++) {
+            visit(records[i]);
+        }
+        if (count == 0) {
+            malformed++;
+        }
+    }
+
+    static bool parseId(const char*& p, TraceRecord& record) {
+        const char* id_begin = skipSpaces(p);
+        const char* id_end = tokenEnd(id_begin);
+        size_t id_length = id_end - id_begin;
+        if (id_length == 0 || id_length > TraceRecord::MAX_ID) {
+            return false;
+        }
+        memset(record.account_id, 0, sizeof(record.account_id));
+        memcpy(record.account_id, id_begin, id_length);
+        p = id_end;
+        return true;
+    }
+
+public:
+    // Parse one text line into its records (two for a transfer); returns 0
+    // for malformed lines
+    static size_t parseTextRecord(const char* line, TraceRecord (&records)[2]) {
+        TraceRecord& record = records[0];
+        const char* op_begin = skipSpaces(line);
+        const char* op_end = tokenEnd(op_begin);
+        if (tokenIs(op_begin, op_end, "deposit")) {
+            record.op = (uint8_t)TraceOp::DEPOSIT;
+        } else if (tokenIs(op_begin, op_end, "withdraw")) {
+            record.op = (uint8_t)TraceOp::WITHDRAW;
+        } else if (tokenIs(op_begin, op_end, "balance")) {
+            record.op = (uint8_t)TraceOp::BALANCE;
+        } else if (tokenIs(op_begin, op_end, "create")) {
+            record.op = (uint8_t)TraceOp::CREATE;
+        } else if (tokenIs(op_begin, op_end, "transfer")) {
+            record.op = (uint8_t)TraceOp::TRANSFER;
+        } else {
+            return 0;
+        }
+
+        const char* p = op_end;
+        bool transfer = record.op == (uint8_t)TraceOp::TRANSFER;
+        if (!parseId(p, record) || (transfer && !parseId(p, records[1]))) {
+            return 0;
+        }
+
+        const char* amount = skipSpaces(p);
+        record.amount_cents = 0;
+        if (record.op == (uint8_t)TraceOp::BALANCE) {
+            return *amount == '\0' ? 1 : 0;
+        }
+        char* amount_end = nullptr;
+        double value = strtod(amount, &amount_end);
+        if (amount_end == amount || *skipSpaces(amount_end) != '\0' || value < 0) {
+            return 0;
+        }
+        record.amount_cents = toCents(value);
+        if (!transfer) {
+            return 1;
+        }
+        if (record.amount_cents <= 0) {
+            return 0;
+        }
+        records[1].op = (uint8_t)TraceOp::TRANSFER_TO;
+        records[1].amount_cents = record.amount_cents;
+        return 2;
+    }
+
+    // Detects the format from the file header
+    bool open(const string& trace_path) {
+        path = trace_path;
+        record_count = 0;
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) {
+            return false;
+        }
+        TraceHeader header;
+        size_t got = fread(&header, 1, sizeof(header), in);
+        fclose(in);
+        if (got == sizeof(header) && memcmp(header.magic, MAGIC, sizeof(header.magic)) == 0) {
+            if (header.record_size != sizeof(TraceRecord)) {
+                return false;
+            }
+            trace_format = BINARY;
+            record_count = header.record_count;
+        } else {
+            trace_format = TEXT;
+        }
+        return true;
+    }
+
+    Format format() const {
+        return trace_format;
+    }
+
+    uint64_t declaredRecords() const {
+        return record_count;
+    }
+
+    // visit(const TraceRecord&) is called once per well-formed record in file order
+    template <typename Visit>
+    bool forEach(Visit visit, uint64_t& malformed) {
+        malformed = 0;
+        return trace_format == BINARY ? forEachBinary(visit) : forEachText(visit, malformed);
+    }
+
+    // Rewrite a trace (usually text) in the binary format
+    static bool convert(const string& input_path, const string& output_path, uint64_t& written, uint64_t& malformed) {
+        TransactionTrace input;
+        FILE* out = input.open(input_path) ? fopen(output_path.c_str(), "wb") : nullptr;
+        if (!out) {
+            return false;
+        }
+        TraceHeader header;
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(TraceRecord);
+        header.reserved = 0;
+        header.record_count = 0;
+        fwrite(&header, sizeof(header), 1, out);
+
+        vector<TraceRecord> block;
+        block.reserve(READ_CHUNK / sizeof(TraceRecord));
+        written = 0;
+        bool ok = input.forEach([&](const TraceRecord& record) {
+            block.push_back(record);
+            if (block.size() == block.capacity()) {
+                written += fwrite(block.data(), sizeof(TraceRecord), block.size(), out);
+                block.clear();
+            }
+        }, malformed);
+        written += fwrite(block.data(), sizeof(TraceRecord), block.size(), out);
+
+        header.record_count = written;
+        fseek(out, 0, SEEK_SET);
+        fwrite(&header, sizeof(header), 1, out);
+        fclose(out);
+        return ok;
+    }
+
+    static bool writeBinary(const string& output_path, const vector<TraceRecord>& records) {
+        FILE* out = fopen(output_path.c_str(), "wb");
+        if (!out) {
+            return false;
+        }
+        TraceHeader header;
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(TraceRecord);
+        header.reserved = 0;
+        header.record_count = records.size();
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1
+                  && fwrite(records.data(), sizeof(TraceRecord), records.size(), out) == records.size();
+        return fclose(out) == 0 && ok;
+    }
+};
+
+constexpr char TransactionTrace::MAGIC[9];
+
+// One transaction from a trace: a single record, or a TRANSFER record and
+// the TRANSFER_TO that follows it
+struct TraceTransaction {
+    TraceRecord record;
+    TraceRecord destination;         // TRANSFER only
+};
+
+// Pairs TRANSFER records with their TRANSFER_TO; a half without its partner,
+// or a record with an unknown op, counts as malformed
+class TransactionAssembler {
+private:
+    TraceRecord pending;
+    bool has_pending = false;
+
+public:
+    template <typename Emit>
+    void push(const TraceRecord& record, uint64_t& malformed, Emit emit) {
+        if (has_pending && record.op != (uint8_t)TraceOp::TRANSFER_TO) {
+            malformed++;
+            has_pending = false;
+        }
+        if (record.op == (uint8_t)TraceOp::TRANSFER) {
+            pending = record;
+            has_pending = true;
+        } else if (record.op == (uint8_t)TraceOp::TRANSFER_TO) {
+            if (has_pending) {
+                emit(TraceTransaction{pending, record});
+                has_pending = false;
+            } else {
+                malformed++;
+            }
+        } else if (record.op >= (uint8_t)TraceOp::CREATE && record.op <= (uint8_t)TraceOp::BALANCE) {
+            emit(TraceTransaction{record, {}});
+        } else {
+            malformed++;
+        }
+    }
+
+    void finish(uint64_t& malformed) {
+        if (has_pending) {
+            malformed++;
+            has_pending = false;
+        }
+    }
+};
+
+struct ReplayStats {
+    uint64_t records = 0;            // Transactions plus malformed records
+    uint64_t applied = 0;
+    uint64_t not_found = 0;
+    uint64_t insufficient_funds = 0;
+    uint64_t duplicate_accounts = 0;
+    uint64_t invalid_amounts = 0;
+    uint64_t invalid_ids = 0;
+    uint64_t log_failures = 0;
+    uint64_t malformed = 0;
+    uint64_t deposits = 0;
+    uint64_t withdrawals = 0;
+    uint64_t balance_queries = 0;
+    uint64_t creates = 0;
+    uint64_t transfers = 0;
+    uint64_t digest = 14695981039346656037ull; // FNV-1a over every outcome in trace order
+    size_t workers = 0;              // 0 = serial
+    double elapsed_seconds = 0;
+
+    // Called in trace order, so two replays with the same digest gave every
+    // transaction the same result and every balance query the same answer
+    void count(TraceOp op, AccountStatus status, long long balance) {
+        records++;
+        switch (op) {
+        case TraceOp::CREATE: creates++; break;
+        case TraceOp::DEPOSIT: deposits++; break;
+        case TraceOp::WITHDRAW: withdrawals++; break;
+        case TraceOp::BALANCE: balance_queries++; break;
+        default: transfers++; break;
+        }
+        if (status == AccountStatus::OK) {
+            applied++;
+        } else if (status == AccountStatus::NOT_FOUND) {
+            not_found++;
+        } else if (status == AccountStatus::INSUFFICIENT_FUNDS) {
+            insufficient_funds++;
+        } else if (status == AccountStatus::INVALID_AMOUNT) {
+            invalid_amounts++;
+        } else if (status == AccountStatus::INVALID_ID) {
+            invalid_ids++;
+        } else if (status == AccountStatus::LOG_FAILED) {
+            log_failures++;
+        } else {
+            duplicate_accounts++;
+        }
+        digest = (digest ^ (uint64_t)status) * 1099511628211ull;
+        if (op == TraceOp::BALANCE && status == AccountStatus::OK) {
+            for (int i = 0; i < 8; i++) {
+                digest = (digest ^ (((uint64_t)balance >> (8 * i)) & 0xFF)) * 1099511628211ull;
+            }
+        }
+    }
+};
+
+// --- Transaction Management ---
+class TransactionManager {
+private:
+    AccountManager* account_manager;
+    ProcessTable* process_table;
+    ThreadPool* thread_pool;
+
+    // Dependency graph of one replay batch. Every transaction touches at most
+    // two accounts, so it has at most two predecessors and two successors.
+    struct ReplayNode {
+        atomic<uint32_t> pending;     // Unfinished predecessors + 1 for the owner's visit
+        uint32_t next[2];             // Following transaction on each account
+        AccountStatus status;
+        long long balance;
+    };
+
+    struct ReplayGraph {
+        static constexpr uint32_t NONE = UINT32_MAX;
+
+        // Open-addressed account -> latest transaction map; slots from an
+        // earlier batch are recognized by their generation, so a new batch
+        // starts without clearing the table
+        struct Slot {
+            string_view account;
+            uint32_t last;
+            uint32_t generation;
+        };
+
+        unique_ptr<ReplayNode[]> nodes;
+        vector<Slot> slots;
+        uint32_t generation = 1;
+        vector<vector<uint32_t>> owned; // Per worker, in trace order
+
+        ReplayGraph(size_t capacity, size_t workers) : nodes(new ReplayNode[capacity]), owned(workers) {
+            size_t size = 1;
+            while (size < 2 * capacity) {
+                size *= 2;
+            }
+            slots.assign(size, Slot{string_view(), NONE, 0});
+        }
+
+        // Records n as the account's latest transaction and returns the previous one
+        uint32_t exchangeLast(string_view account, size_t hash_value, uint32_t n) {
+            size_t mask = slots.size() - 1;
+            for (size_t i = hash_value & mask;; i = (i + 1) & mask) {
+                Slot& slot = slots[i];
+                if (slot.generation != generation) {
+                    slot = Slot{account, n, generation};
+                    return NONE;
+                }
+                if (slot.account == account) {
+                    uint32_t previous = slot.last;
+                    slot.last = n;
+                    return previous;
+                }
+            }
+        }
+
+        void nextBatch() {
+            if (++generation == 0) { // Wrapped: stale stamps could match again
+                fill(slots.begin(), slots.end(), Slot{string_view(), NONE, 0});
+                generation = 1;
+            }
+            for (auto& list : owned) {
+                list.clear();
+            }
+        }
+    };
+
+    AccountStatus applyTraceTransaction(const TraceTransaction& transaction, long long& balance) {
+        const TraceRecord& record = transaction.record;
+        string account_id(record.id());
+        long long cents = record.amount_cents;
+        switch ((TraceOp)record.op) {
+        case TraceOp::CREATE:
+            return account_manager->createAccountCents(account_id, cents, false);
+        case TraceOp::DEPOSIT:
+            return account_manager->depositCents(account_id, cents, false);
+        case TraceOp::WITHDRAW:
+            return account_manager->withdrawCents(account_id, cents, false);
+        case TraceOp::BALANCE:
+            return account_manager->balanceCents(account_id, balance);
+        default:
+            return account_manager->transferCents(account_id, string(transaction.destination.id()), cents, false);
+        }
+    }
+
+    // Links every transaction to the previous one on each of its accounts,
+    // runs the graph on the pool, then counts the outcomes in trace order.
+    // A transaction's owner (by the hash of its first account) visits it in
+    // trace order; whichever thread clears the last dependency runs it, so
+    // no thread ever waits for another.
+    bool replayBatch(ReplayGraph& graph, const vector<TraceTransaction>& batch, ReplayStats& stats) {
+        const uint32_t NONE = ReplayGraph::NONE;
+        ReplayNode* nodes = graph.nodes.get();
+        size_t workers = graph.owned.size();
+        for (uint32_t n = 0; n < batch.size(); n++) {
+            ReplayNode& node = nodes[n];
+            node.pending.store(1, memory_order_relaxed);
+            node.next[0] = node.next[1] = NONE;
+            string_view accounts[2] = {batch[n].record.id(), batch[n].destination.id()};
+            size_t account_count = batch[n].record.op == (uint8_t)TraceOp::TRANSFER && accounts[1] != accounts[0] ? 2 : 1;
+            uint32_t linked = NONE;
+            size_t owner = 0;
+            for (size_t k = 0; k < account_count; k++) {
+                size_t hash_value = hash<string_view>{}(accounts[k]);
+                owner = k == 0 ? hash_value % workers : owner;
+                uint32_t previous = graph.exchangeLast(accounts[k], hash_value, n);
+                if (previous != NONE && previous != linked) {
+                    nodes[previous].next[batch[previous].record.id() == accounts[k] ? 0 : 1] = n;
+                    node.pending.fetch_add(1, memory_order_relaxed);
+                    linked = previous;
+                }
+            }
+            graph.owned[owner].push_back(n);
+        }
+
+        vector<future<void>> done;
+        for (size_t w = 0; w < workers; w++) {
+            done.push_back(thread_pool->submit([&, w] {
+                vector<uint32_t> ready;
+                for (uint32_t n : graph.owned[w]) {
+                    if (nodes[n].pending.fetch_sub(1, memory_order_acq_rel) != 1) {
+                        continue; // A predecessor is unfinished; its thread runs n
+                    }
+                    ready.push_back(n);
+                    while (!ready.empty()) {
+                        uint32_t m = ready.back();
+                        ready.pop_back();
+                        nodes[m].status = applyTraceTransaction(batch[m], nodes[m].balance);
+                        for (uint32_t successor : nodes[m].next) {
+                            if (successor != NONE && nodes[successor].pending.fetch_sub(1, memory_order_acq_rel) == 1) {
+                                ready.push_back(successor);
+                            }
+                        }
+                    }
+                }
+            }));
+        }
+        for (auto& worker : done) {
+            worker.get();
+        }
+        bool logged = account_manager->flushLog();
+
+        for (uint32_t n = 0; n < batch.size(); n++) {
+            stats.count((TraceOp)batch[n].record.op, nodes[n].status, nodes[n].balance);
+        }
+        graph.nextBatch();
+        return logged;
+    }
+
+public:
+    TransactionManager(AccountManager* am, ProcessTable* pt, ThreadPool* pool)
+        : account_manager(am), process_table(pt), thread_pool(pool) {}
+
+    // For "transfer", account_id is debited and to_account_id credited
+    bool createTransaction(const string& id, const string& action, const string& account_id, double amount = 0, int pid = 0,
+                           const string& to_account_id = "") {
+        if (pid > 0 && process_table) {
+            process_table->updateStatus(pid, ProcessState::RUNNING);
+        }
+        
+        logger().info("transactions", "Transaction {} started", id);
+        long long started = metrics().start();
+        bool ok = false;
+        if (action == "deposit") {
+            ok = account_manager->deposit(account_id, amount);
+            metrics().finish(Metric::TXN_DEPOSIT, started, ok);
+        } else if (action == "withdraw") {
+            ok = account_manager->withdraw(account_id, amount);
+            metrics().finish(Metric::TXN_WITHDRAW, started, ok);
+        } else if (action == "balance") {
+            ok = account_manager->checkBalance(account_id);
+            metrics().finish(Metric::TXN_BALANCE, started, ok);
+        } else if (action == "transfer") {
+            ok = account_manager->transfer(account_id, to_account_id, amount);
+            metrics().finish(Metric::TXN_TRANSFER, started, ok);
+        }
+        logger().info("transactions", "Transaction {} completed", id);
+        
+        if (pid > 0 && process_table) {
+            process_table->updateStatus(pid, ProcessState::COMPLETED);
+        }
+        return ok;
+    }
+
+    // Stream a trace through the account store without console output. Log
+    // records are committed in batches, so replay speed is bounded by reading
+    // the trace and writing the log rather than by one fsync per transaction.
+    bool replayTrace(TransactionTrace& trace, ReplayStats& stats) {
+        const uint64_t COMMIT_BATCH = 65536;
+        uint64_t since_commit = 0;
+        TransactionAssembler assembler;
+        auto start = chrono::steady_clock::now();
+
+        bool ok = trace.forEach([&](const TraceRecord& record) {
+            assembler.push(record, stats.malformed, [&](const TraceTransaction& transaction) {
+                long long balance = 0;
+                AccountStatus status = applyTraceTransaction(transaction, balance);
+                stats.count((TraceOp)transaction.record.op, status, balance);
+            });
+            if (++since_commit == COMMIT_BATCH) {
+                account_manager->flushLog();
+                since_commit = 0;
+            }
+        }, stats.malformed);
+        assembler.finish(stats.malformed);
+        stats.records += stats.malformed;
+        ok = account_manager->flushLog() && ok;
+
+        stats.elapsed_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return ok;
+    }
+
+    // Deterministic parallel replay: the same results as replayTrace, using
+    // up to workers threads (default: the pool size). Transactions are taken
+    // in batches. Within a batch each one waits for the previous transaction
+    // on every account it touches, so each account sees its transactions in
+    // trace order while transactions on different accounts run in parallel.
+    bool replayTraceParallel(TransactionTrace& trace, ReplayStats& stats, size_t workers = 0) {
+        const size_t BATCH = 1 << 18;
+        stats.workers = workers ? workers : thread_pool->size();
+        vector<TraceTransaction> batch;
+        batch.reserve(BATCH);
+        ReplayGraph graph(BATCH, stats.workers);
+        TransactionAssembler assembler;
+        bool logged = true;
+        auto start = chrono::steady_clock::now();
+
+        bool ok = trace.forEach([&](const TraceRecord& record) {
+            assembler.push(record, stats.malformed, [&](const TraceTransaction& transaction) {
+                batch.push_back(transaction);
+                if (batch.size() == BATCH) {
+                    logged = replayBatch(graph, batch, stats) && logged;
+                    batch.clear();
+                }
+            });
+        }, stats.malformed);
+        assembler.finish(stats.malformed);
+        logged = replayBatch(graph, batch, stats) && logged;
+        stats.records += stats.malformed;
+
+        stats.elapsed_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return ok && logged;
+    }
+
+    // Batched multi-leg transaction: all legs (account, cents) apply or none
+    bool createBatch(const string& id, const vector<pair<string, long long>>& legs, int pid = 0) {
+        if (pid > 0 && process_table) {
+            process_table->updateStatus(pid, ProcessState::RUNNING);
+        }
+        logger().info("transactions", "Transaction {} started ({} legs)", id, (int)legs.size());
+        long long started = metrics().start();
+        AccountStatus status = account_manager->applyLegsCents(legs);
+        metrics().finish(Metric::TXN_BATCH, started, status == AccountStatus::OK);
+        if (status == AccountStatus::OK) {
+            logger().info("transactions", "Transaction {} committed", id);
+        } else {
+            logger().warn("transactions", "Transaction {} rolled back: {}", id,
+                          status == AccountStatus::NOT_FOUND ? "unknown account" : "insufficient balance");
+        }
+        if (pid > 0 && process_table) {
+            process_table->updateStatus(pid, ProcessState::COMPLETED);
+        }
+        return status == AccountStatus::OK;
+    }
+
+    // Run a transaction on the worker pool; the future reports whether it succeeded
+    future<bool> submitTransaction(const string& id, const string& action, const string& account_id, double amount = 0, int pid = 0,
+                                   const string& to_account_id = "") {
+        return thread_pool->submit([=] {
+            return createTransaction(id, action, account_id, amount, pid, to_account_id);
+        });
+    }
+
+    future<bool> submitBatch(const string& id, const vector<pair<string, long long>>& legs, int pid = 0) {
+        return thread_pool->submit([=] {
+            return createBatch(id, legs, pid);
+        });
+    }
+};
+
+// --- Scheduling Engine ---
+// Discrete-event simulation of one CPU. Jobs carry their own arrival and
+// burst times; the engine never executes anything, so it can replay millions
+// of simulated processes and the caller decides what to do with the result.
+struct SchedulerJob {
+    int pid;
+    long long arrival_time;
+    long long burst_time;
+    int priority;
+    uint64_t affinity = 0; // Multi-core only: bit n allows CPU n, 0 means any
+};
+
+struct GanttSlice {
+    int pid;
+    long long start_time;
+    long long end_time;
+};
+
+struct JobMetrics {
+    long long completion_time;
+    long long first_run_time;
+    long long turnaround_time;
+    long long waiting_time;
+    long long response_time;
+};
+
+struct SchedulingResult {
+    vector<GanttSlice> gantt;
+    vector<JobMetrics> jobs;      // Same order as the input jobs
+    vector<size_t> completion_order;
+    long long makespan = 0;
+    long long busy_time = 0;
+    long long context_switches = 0;
+    double avg_waiting_time = 0;
+    double avg_turnaround_time = 0;
+    double avg_response_time = 0;
+    double throughput = 0;        // Completed processes per time unit
+    double cpu_utilization = 0;   // Percent of the makespan spent running jobs
+
+    void recordSlice(int pid, long long start, long long end, bool record_gantt) {
+        busy_time += end - start;
+        if (!record_gantt || start == end) {
+            return;
+        }
+        if (!gantt.empty() && gantt.back().pid == pid && gantt.back().end_time == start) {
+            gantt.back().end_time = end; // Same process kept the CPU
+        } else {
+            gantt.push_back({pid, start, end});
+        }
+    }
+
+    void finalize(const vector<SchedulerJob>& input) {
+        long long total_waiting = 0, total_turnaround = 0, total_response = 0;
+        for (size_t i = 0; i < input.size(); i++) {
+            JobMetrics& m = jobs[i];
+            m.turnaround_time = m.completion_time - input[i].arrival_time;
+            m.waiting_time = m.turnaround_time - input[i].burst_time;
+            m.response_time = m.first_run_time - input[i].arrival_time;
+            total_waiting += m.waiting_time;
+            total_turnaround += m.turnaround_time;
+            total_response += m.response_time;
+        }
+        if (!input.empty()) {
+            avg_waiting_time = (double)total_waiting / input.size();
+            avg_turnaround_time = (double)total_turnaround / input.size();
+            avg_response_time = (double)total_response / input.size();
+        }
+        if (makespan > 0) {
+            throughput = (double)input.size() / makespan;
+            cpu_utilization = (double)busy_time / makespan * 100;
+        }
+    }
+};
+
+// Policy hooks called by SchedulingEngine. A policy owns the ready set; the
+// engine owns the clock, arrivals, context switches and metrics, so every
+// policy is measured the same way.
+class SchedulingPolicy {
+public:
+    virtual ~SchedulingPolicy() {}
+    virtual string name() const = 0;
+    virtual void reset(const vector<SchedulerJob>& jobs, const vector<long long>& remaining) = 0;
+    virtual bool empty() const = 0;
+    virtual void onArrival(size_t job, long long now) = 0;
+    virtual size_t pickNext(long long now) = 0; // Removes the job from the ready set
+    virtual long long timeSlice(size_t job, long long now) = 0;
+    virtual void onPreempted(size_t job, long long ran, long long now) = 0;
+    virtual bool preemptsOnArrival() const { return false; }
+    // Removes the first job in pickNext order for which eligible holds; every
+    // other job keeps its place and state. False when no job qualifies.
+    virtual bool takeNext(long long now, const function<bool(size_t)>& eligible, size_t& job) = 0;
+
+protected:
+    static size_t jobOf(size_t job) { return job; }
+    template <typename Key>
+    static size_t jobOf(const pair<Key, size_t>& entry) { return entry.second; }
+
+    template <typename Queue>
+    static bool takeFirst(Queue& queue, const function<bool(size_t)>& eligible, size_t& job) {
+        auto it = find_if(queue.begin(), queue.end(), [&eligible](const auto& entry) { return eligible(jobOf(entry)); });
+        if (it == queue.end()) {
+            return false;
+        }
+        job = jobOf(*it);
+        queue.erase(it);
+        return true;
+    }
+};
+
+// Drives a policy over a workload: sorts by arrival once (O(n log n)), then
+// handles one dispatch per slice.
+class SchedulingEngine {
+private:
+    long long context_switch_cost;
+
+public:
+    explicit SchedulingEngine(long long cs_cost) : context_switch_cost(max(0LL, cs_cost)) {}
+
+    SchedulingResult run(const vector<SchedulerJob>& jobs, SchedulingPolicy& policy, bool record_gantt = true) const {
+        SchedulingResult result;
+        size_t n = jobs.size();
+        result.jobs.assign(n, JobMetrics{0, -1, 0, 0, 0});
+
+        vector<size_t> arrivals(n);
+        for (size_t i = 0; i < n; i++) {
+            arrivals[i] = i;
+        }
+        stable_sort(arrivals.begin(), arrivals.end(), [&jobs](size_t a, size_t b) {
+            return jobs[a].arrival_time < jobs[b].arrival_time;
+        });
+
+        vector<long long> remaining(n);
+        for (size_t i = 0; i < n; i++) {
+            remaining[i] = max(0LL, jobs[i].burst_time);
+        }
+        policy.reset(jobs, remaining);
+
+        size_t next_arrival = 0;
+        long long clock = 0;
+        long long last_pid = -1;
+        auto admitArrivals = [&](long long now) {
+            while (next_arrival < n && jobs[arrivals[next_arrival]].arrival_time <= now) {
+                policy.onArrival(arrivals[next_arrival++], now);
+            }
+        };
+
+        while (result.completion_order.size() < n) {
+            if (policy.empty()) {
+                clock = max(clock, jobs[arrivals[next_arrival]].arrival_time); // CPU idles
+                admitArrivals(clock);
+            }
+            size_t job = policy.pickNext(clock);
+
+            if (last_pid != -1 && last_pid != jobs[job].pid) {
+                clock += context_switch_cost;
+                result.context_switches++;
+                admitArrivals(clock);
+            }
+            if (result.jobs[job].first_run_time < 0) {
+                result.jobs[job].first_run_time = clock;
+            }
+
+            long long slice = min(policy.timeSlice(job, clock), remaining[job]);
+            if (policy.preemptsOnArrival() && next_arrival < n) {
+                slice = min(slice, jobs[arrivals[next_arrival]].arrival_time - clock);
+            }
+            result.recordSlice(jobs[job].pid, clock, clock + slice, record_gantt);
+            clock += slice;
+            remaining[job] -= slice;
+            last_pid = jobs[job].pid;
+
+            // Arrivals during the slice queue ahead of the preempted process
+            admitArrivals(clock);
+            if (remaining[job] > 0) {
+                policy.onPreempted(job, slice, clock);
+            } else {
+                result.jobs[job].completion_time = clock;
+                result.completion_order.push_back(job);
+            }
+        }
+
+        result.makespan = clock;
+        result.finalize(jobs);
+        return result;
+    }
+};
+
+// --- Scheduling Policies ---
+// First Come First Serve: non-preemptive, in arrival order
+class FCFSPolicy : public SchedulingPolicy {
+private:
+    deque<size_t> ready_queue;
+
+public:
+    string name() const override { return "FCFS (First Come First Serve)"; }
+    void reset(const vector<SchedulerJob>&, const vector<long long>&) override { ready_queue.clear(); }
+    bool empty() const override { return ready_queue.empty(); }
+    void onArrival(size_t job, long long) override { ready_queue.push_back(job); }
+    size_t pickNext(long long) override {
+        size_t job = ready_queue.front();
+        ready_queue.pop_front();
+        return job;
+    }
+    long long timeSlice(size_t, long long) override { return LLONG_MAX; }
+    void onPreempted(size_t job, long long, long long) override { ready_queue.push_front(job); }
+    bool takeNext(long long, const function<bool(size_t)>& eligible, size_t& job) override {
+        return takeFirst(ready_queue, eligible, job);
+    }
+};
+
+// Round Robin: FIFO ready queue, fixed quantum, re-enqueue on quantum expiry
+class RoundRobinPolicy : public SchedulingPolicy {
+private:
+    long long quantum;
+    deque<size_t> ready_queue;
+
+public:
+    explicit RoundRobinPolicy(long long q) : quantum(max(1LL, q)) {}
+    string name() const override { return "ROUND ROBIN (Time Quantum = " + to_string(quantum) + ")"; }
+    void reset(const vector<SchedulerJob>&, const vector<long long>&) override { ready_queue.clear(); }
+    bool empty() const override { return ready_queue.empty(); }
+    void onArrival(size_t job, long long) override { ready_queue.push_back(job); }
+    size_t pickNext(long long) override {
+        size_t job = ready_queue.front();
+        ready_queue.pop_front();
+        return job;
+    }
+    long long timeSlice(size_t, long long) override { return quantum; }
+    void onPreempted(size_t job, long long, long long) override { ready_queue.push_back(job); }
+    bool takeNext(long long, const function<bool(size_t)>& eligible, size_t& job) override {
+        return takeFirst(ready_queue, eligible, job);
+    }
+};
+
+// Shortest Job First (non-preemptive) and Shortest Remaining Time First
+// (preempts whenever a new job arrives). Both keep an ordered set keyed by
+// the remaining burst; only the running job's key changes, and it is re-inserted.
+class ShortestJobPolicy : public SchedulingPolicy {
+private:
+    bool preemptive;
+    const vector<long long>* remaining = nullptr;
+    set<pair<long long, size_t>> ready_set;
+
+public:
+    explicit ShortestJobPolicy(bool srtf) : preemptive(srtf) {}
+    string name() const override {
+        return preemptive ? "SRTF (Shortest Remaining Time First)" : "SJF (Shortest Job First)";
+    }
+    void reset(const vector<SchedulerJob>&, const vector<long long>& rem) override {
+        remaining = &rem;
+        ready_set.clear();
+    }
+    bool empty() const override { return ready_set.empty(); }
+    void onArrival(size_t job, long long) override { ready_set.insert({(*remaining)[job], job}); }
+    size_t pickNext(long long) override {
+        size_t job = ready_set.begin()->second;
+        ready_set.erase(ready_set.begin());
+        return job;
+    }
+    long long timeSlice(size_t, long long) override { return LLONG_MAX; }
+    void onPreempted(size_t job, long long, long long) override { ready_set.insert({(*remaining)[job], job}); }
+    bool preemptsOnArrival() const override { return preemptive; }
+    bool takeNext(long long, const function<bool(size_t)>& eligible, size_t& job) override {
+        return takeFirst(ready_set, eligible, job);
+    }
+};
+
+// Non-preemptive priority (lower value = higher priority) with aging: a job
+// gains one priority level per aging_interval spent waiting. Comparing
+//   priority_a - wait_a / interval  vs  priority_b - wait_b / interval
+// at any instant is equivalent to comparing priority * interval + ready_since,
+// so the ready set is an ordered set with a time-independent key.
+class PriorityAgingPolicy : public SchedulingPolicy {
+private:
+    long long aging_interval;
+    const vector<SchedulerJob>* jobs = nullptr;
+    set<pair<long long, size_t>> ready_set;
+
+    void add(size_t job, long long now) {
+        ready_set.insert({(long long)(*jobs)[job].priority * aging_interval + now, job});
+    }
+
+public:
+    explicit PriorityAgingPolicy(long long interval) : aging_interval(max(1LL, interval)) {}
+    string name() const override {
+        return "PRIORITY with Aging (interval " + to_string(aging_interval) + ")";
+    }
+    void reset(const vector<SchedulerJob>& j, const vector<long long>&) override {
+        jobs = &j;
+        ready_set.clear();
+    }
+    bool empty() const override { return ready_set.empty(); }
+    void onArrival(size_t job, long long) override { add(job, (*jobs)[job].arrival_time); }
+    size_t pickNext(long long) override {
+        size_t job = ready_set.begin()->second;
+        ready_set.erase(ready_set.begin());
+        return job;
+    }
+    long long timeSlice(size_t, long long) override { return LLONG_MAX; }
+    void onPreempted(size_t job, long long, long long now) override { add(job, now); }
+    bool takeNext(long long, const function<bool(size_t)>& eligible, size_t& job) override {
+        return takeFirst(ready_set, eligible, job); // The key keeps the job's accumulated aging
+    }
+};
+
+// Multi-Level Feedback Queue: level k has quantum base * 2^k. A job that uses
+// its whole quantum drops one level; every boost_period all jobs return to the
+// top level (list splicing makes the boost O(levels)).
+class MLFQPolicy : public SchedulingPolicy {
+private:
+    static const int LEVELS = 3;
+    long long base_quantum;
+    long long boost_period;
+    long long next_boost;
+    list<size_t> queues[LEVELS];
+    vector<int> level;
+
+    void boostIfDue(long long now) {
+        if (now < next_boost) {
+            return;
+        }
+        for (int k = 1; k < LEVELS; k++) {
+            for (size_t job : queues[k]) {
+                level[job] = 0;
+            }
+            queues[0].splice(queues[0].end(), queues[k]);
+        }
+        next_boost = (now / boost_period + 1) * boost_period;
+    }
+
+public:
+    MLFQPolicy(long long q, long long boost) : base_quantum(max(1LL, q)), boost_period(max(1LL, boost)), next_boost(0) {}
+    string name() const override {
+        return "MLFQ (" + to_string(LEVELS) + " levels, quantum " + to_string(base_quantum)
+               + ", boost " + to_string(boost_period) + ")";
+    }
+    void reset(const vector<SchedulerJob>& jobs, const vector<long long>&) override {
+        for (auto& queue : queues) {
+            queue.clear();
+        }
+        level.assign(jobs.size(), 0);
+        next_boost = boost_period;
+    }
+    bool empty() const override {
+        for (const auto& queue : queues) {
+            if (!queue.empty()) return false;
+        }
+        return true;
+    }
+    void onArrival(size_t job, long long) override { queues[0].push_back(job); }
+    size_t pickNext(long long now) override {
+        boostIfDue(now);
+        for (auto& queue : queues) {
+            if (!queue.empty()) {
+                size_t job = queue.front();
+                queue.pop_front();
+                return job;
+            }
+        }
+        return 0; // Unreachable: the engine only asks when a job is ready
+    }
+    long long timeSlice(size_t job, long long) override { return base_quantum << level[job]; }
+    void onPreempted(size_t job, long long ran, long long) override {
+        if (ran >= (base_quantum << level[job]) && level[job] < LEVELS - 1) {
+            level[job]++;
+        }
+        queues[level[job]].push_back(job);
+    }
+    bool takeNext(long long now, const function<bool(size_t)>& eligible, size_t& job) override {
+        boostIfDue(now);
+        for (auto& queue : queues) {
+            if (takeFirst(queue, eligible, job)) {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+// CFS-like fair scheduler: the ready set is a red-black tree (std::set) keyed
+// by virtual runtime, which advances by ran * NICE_0_WEIGHT / weight. The
+// slice is the job's weighted share of the target latency. Priority maps to a
+// nice value in [-20, 19].
+class CFSPolicy : public SchedulingPolicy {
+private:
+    static const long long NICE_0_WEIGHT = 1024;
+    long long target_latency;
+    long long min_granularity;
+    const vector<SchedulerJob>* jobs = nullptr;
+    set<pair<double, size_t>> timeline;
+    vector<double> vruntime;
+    long long ready_weight = 0;
+    double min_vruntime = 0;
+
+    static long long weightOf(int priority) {
+        static const long long prio_to_weight[40] = {
+            88761, 71755, 56483, 46273, 36291, 29154, 23254, 18705, 14949, 11916,
+            9548, 7620, 6100, 4904, 3906, 3121, 2501, 1991, 1586, 1277,
+            1024, 820, 655, 526, 423, 335, 272, 215, 172, 137,
+            110, 87, 70, 56, 45, 36, 29, 23, 18, 15};
+        int nice = max(-20, min(19, priority));
+        return prio_to_weight[nice + 20];
+    }
+
+    void add(size_t job) {
+        timeline.insert({vruntime[job], job});
+        ready_weight += weightOf((*jobs)[job].priority);
+    }
+
+public:
+    CFSPolicy(long long latency, long long granularity)
+        : target_latency(max(1LL, latency)), min_granularity(max(1LL, granularity)) {}
+    string name() const override {
+        return "CFS (target latency " + to_string(target_latency) + ")";
+    }
+    void reset(const vector<SchedulerJob>& j, const vector<long long>&) override {
+        jobs = &j;
+        timeline.clear();
+        vruntime.assign(j.size(), 0);
+        ready_weight = 0;
+        min_vruntime = 0;
+    }
+    bool empty() const override { return timeline.empty(); }
+    void onArrival(size_t job, long long) override {
+        vruntime[job] = max(vruntime[job], min_vruntime); // New jobs start at the current minimum
+        add(job);
+    }
+    size_t pickNext(long long) override {
+        auto leftmost = timeline.begin();
+        size_t job = leftmost->second;
+        min_vruntime = max(min_vruntime, leftmost->first);
+        timeline.erase(leftmost);
+        ready_weight -= weightOf((*jobs)[job].priority);
+        return job;
+    }
+    long long timeSlice(size_t job, long long) override {
+        long long weight = weightOf((*jobs)[job].priority);
+        long long share = target_latency * weight / (ready_weight + weight);
+        return max(min_granularity, share);
+    }
+    void onPreempted(size_t job, long long ran, long long) override {
+        vruntime[job] += (double)ran * NICE_0_WEIGHT / weightOf((*jobs)[job].priority);
+        add(job);
+    }
+    bool takeNext(long long, const function<bool(size_t)>& eligible, size_t& job) override {
+        double leftmost = timeline.empty() ? min_vruntime : timeline.begin()->first;
+        if (!takeFirst(timeline, eligible, job)) {
+            return false;
+        }
+        min_vruntime = max(min_vruntime, leftmost); // Still the smallest ready vruntime
+        ready_weight -= weightOf((*jobs)[job].priority);
+        return true;
+    }
+};
+
+// --- Kernel Simulation ---
+// Event-driven model of one CPU, one disk and per-process IPC mailboxes. Each
+// process runs a small program of CPU bursts, disk requests and message
+// sends/receives. It is READY while queued for the CPU, RUNNING on it and
+// WAITING while a disk request or receive is outstanding, so CPU bursts of
+// some processes overlap with the I/O of others. The SchedulingPolicy picks
+// who runs; the policy sees the current burst as the job's remaining time.
+enum class OperationKind : uint8_t { CPU, DISK, SEND, RECEIVE };
+
+struct ProcessOperation {
+    OperationKind kind;
+    long long value; // CPU: burst length, DISK: block number, SEND: index of the receiving process
+};
+
+struct KernelProcess {
+    int pid;
+    long long arrival_time;
+    int priority;
+    vector<ProcessOperation> program;
+};
+
+struct KernelProcessMetrics {
+    long long completion_time = -1; // Stays -1 if the process never finished
+    long long first_run_time = -1;
+    long long cpu_time = 0;
+    long long ready_wait_time = 0;  // Runnable but not on the CPU
+    long long disk_wait_time = 0;   // Queued for or being served by the disk
+    long long ipc_wait_time = 0;    // Blocked in a receive
+    long long turnaround_time = 0;
+};
+
+struct KernelResult {
+    vector<GanttSlice> gantt;      // CPU
+    vector<GanttSlice> disk_gantt; // Disk service, one slice per request
+    vector<KernelProcessMetrics> processes;
+    long long makespan = 0;
+    long long cpu_busy = 0;
+    long long disk_busy = 0;
+    long long overlap = 0;         // Time the CPU and the disk were both busy
+    long long context_switches = 0;
+    long long disk_requests = 0;
+    long long messages = 0;
+    size_t completed = 0;
+    double avg_waiting_time = 0;
+    double avg_turnaround_time = 0;
+    double avg_response_time = 0;
+    double throughput = 0;
+    double cpu_utilization = 0;
+    double disk_utilization = 0;
+};
+
+class KernelSimulator {
+private:
+    long long context_switch_cost;
+    long long disk_transfer_time; // Fixed cost per request
+    long long seek_tracks_per_unit; // Head speed
+    long long ipc_latency;          // Send to delivery
+
+    enum EventType { ARRIVAL, DISK_DONE, MESSAGE };
+
+    struct Event {
+        long long time;
+        unsigned long long sequence; // FIFO among events at the same time
+        EventType type;
+        size_t job;
+        bool operator>(const Event& other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+
+    static long long intersect(const vector<GanttSlice>& a, const vector<GanttSlice>& b) {
+        long long total = 0;
+        size_t i = 0, j = 0;
+        while (i < a.size() && j < b.size()) {
+            total += max(0LL, min(a[i].end_time, b[j].end_time) - max(a[i].start_time, b[j].start_time));
+            if (a[i].end_time < b[j].end_time) {
+                i++;
+            } else {
+                j++;
+            }
+        }
+        return total;
+    }
+
+public:
+    KernelSimulator(long long cs_cost, long long transfer_time = 2, long long tracks_per_unit = 25,
+                    long long message_latency = 1)
+        : context_switch_cost(max(0LL, cs_cost)), disk_transfer_time(max(0LL, transfer_time)),
+          seek_tracks_per_unit(max(1LL, tracks_per_unit)), ipc_latency(max(0LL, message_latency)) {}
+
+    // on_transition(job, state, time) is called for every state change
+    KernelResult run(const vector<KernelProcess>& processes, SchedulingPolicy& policy,
+                     const function<void(size_t, ProcessState, long long)>& on_transition = nullptr) const {
+        size_t n = processes.size();
+        KernelResult result;
+        result.processes.assign(n, KernelProcessMetrics());
+
+        vector<SchedulerJob> jobs;
+        for (const auto& process : processes) {
+            long long total_cpu = 0;
+            for (const auto& op : process.program) {
+                if (op.kind == OperationKind::CPU) {
+                    total_cpu += max(0LL, op.value);
+                }
+            }
+            jobs.push_back({process.pid, process.arrival_time, total_cpu, process.priority});
+        }
+        vector<long long> remaining(n, 0); // Of the current CPU burst
+        policy.reset(jobs, remaining);
+
+        vector<size_t> pc(n, 0);
+        vector<long long> ready_since(n, 0), blocked_since(n, 0);
+        vector<long long> mailbox(n, 0);
+        vector<bool> receiving(n, false);
+
+        priority_queue<Event, vector<Event>, greater<Event>> events;
+        unsigned long long sequence = 0;
+        auto post = [&](long long time, EventType type, size_t job) {
+            events.push({time, sequence++, type, job});
+        };
+        for (size_t i = 0; i < n; i++) {
+            post(processes[i].arrival_time, ARRIVAL, i);
+        }
+
+        auto transition = [&](size_t job, ProcessState state, long long now) {
+            if (on_transition) {
+                on_transition(job, state, now);
+            }
+        };
+
+        // Shortest seek first over the pending requests
+        set<pair<long long, size_t>> disk_queue;
+        bool disk_busy = false;
+        long long disk_head = 0;
+        auto startDisk = [&](long long now) {
+            if (disk_busy || disk_queue.empty()) {
+                return;
+            }
+            auto next = disk_queue.lower_bound({disk_head, 0});
+            if (next == disk_queue.end()
+                || (next != disk_queue.begin() && disk_head - prev(next)->first <= next->first - disk_head)) {
+                next = prev(next);
+            }
+            long long block = next->first;
+            size_t job = next->second;
+            disk_queue.erase(next);
+            long long service = disk_transfer_time + llabs(block - disk_head) / seek_tracks_per_unit;
+            disk_head = block;
+            disk_busy = true;
+            result.disk_busy += service;
+            result.disk_gantt.push_back({processes[job].pid, now, now + service});
+            post(now + service, DISK_DONE, job);
+        };
+
+        // Execute the job's zero-time operations until it needs the CPU,
+        // blocks or exits
+        auto advance = [&](size_t job, long long now) {
+            const vector<ProcessOperation>& program = processes[job].program;
+            while (pc[job] < program.size()) {
+                const ProcessOperation& op = program[pc[job]];
+                if (op.kind == OperationKind::CPU) {
+                    pc[job]++;
+                    if (op.value <= 0) {
+                        continue;
+                    }
+                    remaining[job] = op.value;
+                    ready_since[job] = now;
+                    transition(job, ProcessState::READY, now);
+                    policy.onArrival(job, now);
+                    return;
+                }
+                if (op.kind == OperationKind::DISK) {
+                    pc[job]++;
+                    blocked_since[job] = now;
+                    disk_queue.insert({op.value, job});
+                    result.disk_requests++;
+                    transition(job, ProcessState::WAITING, now);
+                    startDisk(now);
+                    return;
+                }
+                if (op.kind == OperationKind::SEND) {
+                    pc[job]++;
+                    if (op.value >= 0 && (size_t)op.value < n) {
+                        result.messages++;
+                        post(now + ipc_latency, MESSAGE, (size_t)op.value);
+                    }
+                    continue;
+                }
+                if (mailbox[job] > 0) { // RECEIVE with a message already queued
+                    mailbox[job]--;
+                    pc[job]++;
+                    continue;
+                }
+                receiving[job] = true;
+                blocked_since[job] = now;
+                transition(job, ProcessState::WAITING, now);
+                return;
+            }
+            result.processes[job].completion_time = now;
+            result.completed++;
+            transition(job, ProcessState::COMPLETED, now);
+        };
+
+        auto processEventsUntil = [&](long long until) {
+            while (!events.empty() && events.top().time <= until) {
+                Event event = events.top();
+                events.pop();
+                if (event.type == ARRIVAL) {
+                    advance(event.job, event.time);
+                } else if (event.type == DISK_DONE) {
+                    disk_busy = false;
+                    result.processes[event.job].disk_wait_time += event.time - blocked_since[event.job];
+                    advance(event.job, event.time);
+                    startDisk(event.time);
+                } else if (receiving[event.job]) {
+                    receiving[event.job] = false;
+                    result.processes[event.job].ipc_wait_time += event.time - blocked_since[event.job];
+                    pc[event.job]++; // The RECEIVE completes
+                    advance(event.job, event.time);
+                } else {
+                    mailbox[event.job]++;
+                }
+            }
+        };
+
+        long long clock = 0;
+        long long last_pid = -1;
+        while (true) {
+            processEventsUntil(clock);
+            if (policy.empty()) {
+                if (events.empty()) {
+                    break; // Finished, or the rest wait on messages that never come
+                }
+                clock = events.top().time; // CPU idles
+                continue;
+            }
+            size_t job = policy.pickNext(clock);
+            if (last_pid != -1 && last_pid != processes[job].pid) {
+                clock += context_switch_cost;
+                result.context_switches++;
+                processEventsUntil(clock);
+            }
+
+            KernelProcessMetrics& metrics = result.processes[job];
+            metrics.ready_wait_time += clock - ready_since[job];
+            if (metrics.first_run_time < 0) {
+                metrics.first_run_time = clock;
+            }
+            transition(job, ProcessState::RUNNING, clock);
+
+            long long slice = min(policy.timeSlice(job, clock), remaining[job]);
+            if (policy.preemptsOnArrival() && !events.empty()) {
+                slice = min(slice, events.top().time - clock); // A wakeup may preempt
+            }
+            if (!result.gantt.empty() && result.gantt.back().pid == processes[job].pid
+                && result.gantt.back().end_time == clock) {
+                result.gantt.back().end_time = clock + slice;
+            } else {
+                result.gantt.push_back({processes[job].pid, clock, clock + slice});
+            }
+            result.cpu_busy += slice;
+            metrics.cpu_time += slice;
+            processEventsUntil(clock + slice);
+            clock += slice;
+            remaining[job] -= slice;
+            last_pid = processes[job].pid;
+
+            if (remaining[job] > 0) {
+                ready_since[job] = clock;
+                transition(job, ProcessState::READY, clock);
+                policy.onPreempted(job, slice, clock);
+            } else {
+                advance(job, clock);
+            }
+        }
+
+        long long total_waiting = 0, total_turnaround = 0, total_response = 0;
+        for (size_t i = 0; i < n; i++) {
+            KernelProcessMetrics& metrics = result.processes[i];
+            if (metrics.completion_time < 0) {
+                continue;
+            }
+            metrics.turnaround_time = metrics.completion_time - processes[i].arrival_time;
+            result.makespan = max(result.makespan, metrics.completion_time);
+            total_waiting += metrics.ready_wait_time;
+            total_turnaround += metrics.turnaround_time;
+            total_response += max(0LL, metrics.first_run_time - processes[i].arrival_time);
+        }
+        result.overlap = intersect(result.gantt, result.disk_gantt);
+        if (result.completed > 0) {
+            result.avg_waiting_time = (double)total_waiting / result.completed;
+            result.avg_turnaround_time = (double)total_turnaround / result.completed;
+            result.avg_response_time = (double)total_response / result.completed;
+        }
+        if (result.makespan > 0) {
+            result.throughput = (double)result.completed / result.makespan;
+            result.cpu_utilization = (double)result.cpu_busy / result.makespan * 100;
+            result.disk_utilization = (double)result.disk_busy / result.makespan * 100;
+        }
+        return result;
+    }
+};
+
+// --- Multi-Core Scheduling ---
+// N simulated CPUs, each with its own run queue managed by its own policy
+// instance. Arrivals go to the least-loaded CPU their affinity allows, an
+// idle CPU steals from the longest queue, and a periodic balancer evens out
+// queue lengths. A job that resumes on a different CPU than it last ran on
+// counts as a migration and pays migration_cost (a cold cache).
+struct CoreStats {
+    long long busy_time = 0;
+    long long context_switches = 0;
+    long long dispatches = 0;
+    double utilization = 0;
+    vector<GanttSlice> gantt;
+};
+
+struct MultiCoreResult {
+    SchedulingResult summary; // Job metrics; cpu_utilization averages all cores
+    vector<CoreStats> cores;
+    long long migrations = 0;
+    long long steals = 0;
+    long long balance_moves = 0;
+};
+
+class MultiCoreEngine {
+private:
+    int cpu_count;
+    long long context_switch_cost;
+    long long migration_cost;
+    long long balance_interval; // 0 disables periodic balancing
+
+    struct Core {
+        unique_ptr<SchedulingPolicy> policy;
+        size_t queued = 0;
+        bool running = false;
+        size_t job = 0;
+        long long slice = 0;
+        long long last_pid = -1;
+    };
+
+    static bool allowed(const SchedulerJob& job, int cpu) {
+        return job.affinity == 0 || ((job.affinity >> cpu) & 1);
+    }
+
+public:
+    MultiCoreEngine(int cpus, long long cs_cost, long long migrate_cost = 1, long long balance_period = 10)
+        : cpu_count(max(1, min(cpus, 64))), context_switch_cost(max(0LL, cs_cost)),
+          migration_cost(max(0LL, migrate_cost)), balance_interval(max(0LL, balance_period)) {}
+
+    MultiCoreResult run(const vector<SchedulerJob>& jobs, const function<unique_ptr<SchedulingPolicy>()>& make_policy,
+                        bool record_gantt = true) const {
+        MultiCoreResult result;
+        SchedulingResult& summary = result.summary;
+        size_t n = jobs.size();
+        summary.jobs.assign(n, JobMetrics{0, -1, 0, 0, 0});
+        result.cores.assign(cpu_count, CoreStats());
+
+        vector<long long> remaining(n);
+        for (size_t i = 0; i < n; i++) {
+            remaining[i] = max(0LL, jobs[i].burst_time);
+        }
+        vector<Core> cores(cpu_count);
+        for (auto& core : cores) {
+            core.policy = make_policy();
+            core.policy->reset(jobs, remaining);
+        }
+
+        vector<size_t> arrivals(n);
+        for (size_t i = 0; i < n; i++) {
+            arrivals[i] = i;
+        }
+        stable_sort(arrivals.begin(), arrivals.end(), [&jobs](size_t a, size_t b) {
+            return jobs[a].arrival_time < jobs[b].arrival_time;
+        });
+        size_t next_arrival = 0;
+        vector<int> last_cpu(n, -1);
+
+        // (time, cpu): the slice running on cpu ends at time
+        priority_queue<pair<long long, int>, vector<pair<long long, int>>, greater<pair<long long, int>>> slice_ends;
+        // The balancer only acts on queue changes, which happen at arrivals and
+        // slice ends. After a pass that changes nothing it sleeps until the
+        // next such event, so idle gaps and long bursts cost no extra passes.
+        bool balancing = balance_interval > 0 && cpu_count > 1;
+        bool balancer_armed = balancing;
+        long long next_balance = balance_interval;
+        auto armBalancer = [&](long long now) {
+            if (balancing && !balancer_armed) {
+                balancer_armed = true;
+                next_balance = now + balance_interval;
+            }
+        };
+
+        auto enqueue = [&](int cpu, size_t job, long long now, bool preempted, long long ran) {
+            if (preempted) {
+                cores[cpu].policy->onPreempted(job, ran, now);
+            } else {
+                cores[cpu].policy->onArrival(job, now);
+            }
+            cores[cpu].queued++;
+        };
+
+        // Move the victim's next job that the thief may run, in the victim's
+        // own order. Jobs pinned away from the thief are skipped in place, so
+        // they keep their queue position and aging.
+        auto migrate = [&](int victim, int thief, long long now) {
+            size_t job;
+            if (!cores[victim].policy->takeNext(now, [&](size_t candidate) { return allowed(jobs[candidate], thief); }, job)) {
+                return false;
+            }
+            cores[victim].queued--;
+            enqueue(thief, job, now, false, 0);
+            return true;
+        };
+
+        auto steal = [&](int thief, long long now) {
+            vector<int> victims;
+            for (int cpu = 0; cpu < cpu_count; cpu++) {
+                if (cpu != thief && cores[cpu].queued > 0) {
+                    victims.push_back(cpu);
+                }
+            }
+            sort(victims.begin(), victims.end(), [&cores](int a, int b) { return cores[a].queued > cores[b].queued; });
+            for (int victim : victims) {
+                if (migrate(victim, thief, now)) {
+                    result.steals++;
+                    return true;
+                }
+            }
+            return false;
+        };
+
+        auto dispatch = [&](int cpu, long long now) {
+            Core& core = cores[cpu];
+            if (core.running || (core.queued == 0 && !steal(cpu, now))) {
+                return;
+            }
+            size_t job = core.policy->pickNext(now);
+            core.queued--;
+            CoreStats& stats = result.cores[cpu];
+            long long start = now;
+            if (core.last_pid != -1 && core.last_pid != jobs[job].pid) {
+                start += context_switch_cost;
+                stats.context_switches++;
+                summary.context_switches++;
+            }
+            if (last_cpu[job] != -1 && last_cpu[job] != cpu) {
+                start += migration_cost;
+                result.migrations++;
+            }
+            if (summary.jobs[job].first_run_time < 0) {
+                summary.jobs[job].first_run_time = start;
+            }
+            long long slice = min(core.policy->timeSlice(job, start), remaining[job]);
+            if (core.policy->preemptsOnArrival() && next_arrival < n) {
+                slice = min(slice, max(1LL, jobs[arrivals[next_arrival]].arrival_time - start));
+            }
+            stats.busy_time += slice;
+            stats.dispatches++;
+            summary.busy_time += slice;
+            if (record_gantt && slice > 0) {
+                if (!stats.gantt.empty() && stats.gantt.back().pid == jobs[job].pid && stats.gantt.back().end_time == start) {
+                    stats.gantt.back().end_time = start + slice;
+                } else {
+                    stats.gantt.push_back({jobs[job].pid, start, start + slice});
+                }
+            }
+            core.running = true;
+            core.job = job;
+            core.slice = slice;
+            core.last_pid = jobs[job].pid;
+            last_cpu[job] = cpu;
+            slice_ends.push({start + slice, cpu});
+        };
+
+        auto dispatchIdle = [&](long long now) {
+            for (int cpu = 0; cpu < cpu_count; cpu++) {
+                dispatch(cpu, now);
+            }
+        };
+
+        while (summary.completion_order.size() < n) {
+            long long arrival_time = next_arrival < n ? jobs[arrivals[next_arrival]].arrival_time : LLONG_MAX;
+            long long slice_time = slice_ends.empty() ? LLONG_MAX : slice_ends.top().first;
+            long long now = min(min(arrival_time, slice_time), balancer_armed ? next_balance : LLONG_MAX);
+
+            if (slice_time == now) {
+                armBalancer(now);
+                int cpu = slice_ends.top().second;
+                slice_ends.pop();
+                Core& core = cores[cpu];
+                size_t job = core.job;
+                core.running = false;
+                remaining[job] -= core.slice;
+                if (remaining[job] > 0) {
+                    enqueue(cpu, job, now, true, core.slice);
+                } else {
+                    summary.jobs[job].completion_time = now;
+                    summary.completion_order.push_back(job);
+                    summary.makespan = max(summary.makespan, now);
+                }
+                dispatch(cpu, now);
+            } else if (arrival_time == now) {
+                // Least-loaded allowed CPU, counting the job it is running
+                armBalancer(now);
+                size_t job = arrivals[next_arrival++];
+                int target = -1;
+                size_t best_load = SIZE_MAX;
+                for (int cpu = 0; cpu < cpu_count; cpu++) {
+                    size_t load = cores[cpu].queued + (cores[cpu].running ? 1 : 0);
+                    if (allowed(jobs[job], cpu) && load < best_load) {
+                        best_load = load;
+                        target = cpu;
+                    }
+                }
+                enqueue(target < 0 ? 0 : target, job, now, false, 0);
+                dispatch(target < 0 ? 0 : target, now);
+            } else {
+                // Periodic balance: move jobs from the longest to the shortest queue
+                long long moves_before = result.balance_moves, steals_before = result.steals;
+                for (int moves = 0; moves < cpu_count; moves++) {
+                    int busiest = 0, idlest = 0;
+                    for (int cpu = 1; cpu < cpu_count; cpu++) {
+                        if (cores[cpu].queued > cores[busiest].queued) {
+                            busiest = cpu;
+                        }
+                        if (cores[cpu].queued < cores[idlest].queued) {
+                            idlest = cpu;
+                        }
+                    }
+                    if (cores[busiest].queued < cores[idlest].queued + 2 || !migrate(busiest, idlest, now)) {
+                        break;
+                    }
+                    result.balance_moves++;
+                }
+                dispatchIdle(now);
+                next_balance = now + balance_interval;
+                balancer_armed = result.balance_moves != moves_before || result.steals != steals_before;
+            }
+        }
+
+        summary.finalize(jobs);
+        summary.cpu_utilization /= cpu_count;
+        for (auto& stats : result.cores) {
+            if (summary.makespan > 0) {
+                stats.utilization = (double)stats.busy_time / summary.makespan * 100;
+            }
+        }
+        return result;
+    }
+};
+
+// --- CPU Scheduling ---
+struct ScheduledTransaction {
+    string id;
+    string action;
+    string account_id;
+    double amount;
+    int arrival_time;
+    int burst_time;
+    int priority;
+    vector<ProcessOperation> program = {}; // Kernel loop only; empty means one burst of burst_time
+    uint64_t affinity = 0;                  // Multi-core only: bit n allows CPU n, 0 means any
+};
+
+class CPUScheduler {
+private:
+    TransactionManager* transaction_manager;
+    ProcessTable* process_table;
+    int time_quantum;
+    int context_switch_cost;
+
+    // Default CPU demand when a transaction carries no explicit burst time
+    static int estimateBurst(const string& action) {
+        if (action == "balance") return 1;
+        if (action == "deposit") return 3;
+        return 4;
+    }
+
+public:
+    CPUScheduler(TransactionManager* tm, ProcessTable* pt, int quantum = 2, int cs_cost = 1)
+        : transaction_manager(tm), process_table(pt), time_quantum(quantum), context_switch_cost(cs_cost) {}
+
+    void setTimeQuantum(int quantum) {
+        time_quantum = max(1, quantum);
+    }
+
+    void setContextSwitchCost(int cost) {
+        context_switch_cost = max(0, cost);
+    }
+
+    void simulateRoundRobin(const vector<tuple<string, string, string, double>>& transactions) {
+        vector<ScheduledTransaction> scheduled;
+        for (const auto& transaction : transactions) {
+            string id, action, account_id;
+            double amount;
+            tie(id, action, account_id, amount) = transaction;
+            scheduled.push_back({id, action, account_id, amount, 0, estimateBurst(action), 0});
+        }
+        simulateRoundRobin(scheduled);
+    }
+
+    void simulateRoundRobin(const vector<ScheduledTransaction>& transactions) {
+        RoundRobinPolicy policy(time_quantum);
+        simulateScheduling(policy, transactions);
+    }
+
+    // Policies in menu order; index 0 is Round Robin
+    static const int POLICY_COUNT = 7;
+
+    unique_ptr<SchedulingPolicy> makePolicy(int index) const {
+        switch (index) {
+        case 0: return make_unique<RoundRobinPolicy>(time_quantum);
+        case 1: return make_unique<FCFSPolicy>();
+        case 2: return make_unique<ShortestJobPolicy>(false);
+        case 3: return make_unique<ShortestJobPolicy>(true);
+        case 4: return make_unique<PriorityAgingPolicy>(4 * time_quantum);
+        case 5: return make_unique<MLFQPolicy>(time_quantum, 25 * time_quantum);
+        case 6: return make_unique<CFSPolicy>(3 * time_quantum, 1);
+        default: return nullptr;
+        }
+    }
+
+    void simulateScheduling(SchedulingPolicy& policy, const vector<ScheduledTransaction>& transactions) {
+        cout << "\n=== CPU SCHEDULING: " << policy.name() << " (Context Switch = " << context_switch_cost << ") ===\n";
+
+        vector<SchedulerJob> jobs;
+        map<int, const ScheduledTransaction*> by_pid;
+        for (const auto& transaction : transactions) {
+            int pid = process_table->createProcess(transaction.id, transaction.arrival_time, transaction.burst_time);
+            jobs.push_back({pid, transaction.arrival_time, transaction.burst_time, transaction.priority});
+            by_pid[pid] = &transaction;
+        }
+        if (jobs.empty()) {
+            cout << "No transactions to schedule" << endl;
+            return;
+        }
+
+        SchedulingResult result = SchedulingEngine(context_switch_cost).run(jobs, policy);
+
+        logger().flush();
+        cout << "\nGantt Chart:\n";
+        cout << setw(10) << "PID" << setw(15) << "Transaction" << setw(15) << "Start Time" 
+             << setw(15) << "End Time" << endl;
+        cout << string(55, '-') << endl;
+        for (const auto& slice : result.gantt) {
+            cout << setw(10) << slice.pid << setw(15) << by_pid[slice.pid]->id << setw(15) << slice.start_time
+                 << setw(15) << slice.end_time << endl;
+        }
+
+        cout << "\n" << setw(6) << "PID" << setw(10) << "Arrival" << setw(8) << "Burst" << setw(12) << "Completion"
+             << setw(12) << "Turnaround" << setw(10) << "Waiting" << setw(10) << "Response" << endl;
+        cout << string(68, '-') << endl;
+        for (size_t i = 0; i < jobs.size(); i++) {
+            const JobMetrics& m = result.jobs[i];
+            cout << setw(6) << jobs[i].pid << setw(10) << jobs[i].arrival_time << setw(8) << jobs[i].burst_time
+                 << setw(12) << m.completion_time << setw(12) << m.turnaround_time << setw(10) << m.waiting_time
+                 << setw(10) << m.response_time << endl;
+            process_table->setWaitingTime(jobs[i].pid, (int)m.waiting_time);
+            process_table->setTurnaroundTime(jobs[i].pid, (int)m.turnaround_time);
+        }
+
+        // Execute the transactions in the order the schedule completes them
+        cout << endl;
+        for (size_t job : result.completion_order) {
+            const ScheduledTransaction& t = *by_pid[jobs[job].pid];
+            transaction_manager->submitTransaction(t.id, t.action, t.account_id, t.amount, jobs[job].pid).get();
+        }
+        
+        logger().flush();
+        cout << "\n=== CPU SCHEDULING METRICS ===" << endl;
+        cout << "Total Processes: " << jobs.size() << endl;
+        cout << "Average Waiting Time: " << fixed << setprecision(2) << result.avg_waiting_time << " units" << endl;
+        cout << "Average Turnaround Time: " << result.avg_turnaround_time << " units" << endl;
+        cout << "Average Response Time: " << result.avg_response_time << " units" << endl;
+        cout << "Throughput: " << setprecision(4) << result.throughput << " processes/unit" << endl;
+        cout << "CPU Utilization: " << setprecision(2) << result.cpu_utilization << "%" << endl;
+        cout << "Context Switches: " << result.context_switches << endl;
+        cout << "Total CPU Time: " << result.makespan << " units" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        
+        process_table->displayProcessTable();
+    }
+
+    // Run the workload through the kernel loop, where processes block on disk
+    // and IPC and the policy only decides who gets the CPU
+    void simulateKernel(SchedulingPolicy& policy, const vector<ScheduledTransaction>& transactions) {
+        cout << "\n=== KERNEL LOOP: " << policy.name() << " (CPU + Disk + IPC, Context Switch = "
+             << context_switch_cost << ") ===\n";
+
+        vector<KernelProcess> processes;
+        for (const auto& transaction : transactions) {
+            int pid = process_table->createProcess(transaction.id, transaction.arrival_time, transaction.burst_time);
+            vector<ProcessOperation> program = transaction.program;
+            if (program.empty()) {
+                program.push_back({OperationKind::CPU, transaction.burst_time});
+            }
+            processes.push_back({pid, transaction.arrival_time, transaction.priority, program});
+        }
+
+        KernelSimulator kernel(context_switch_cost);
+        KernelResult result = kernel.run(processes, policy, [&](size_t job, ProcessState state, long long) {
+            process_table->updateStatus(processes[job].pid, state);
+        });
+
+        logger().flush();
+        cout << "\nCPU Gantt Chart:\n";
+        for (const auto& slice : result.gantt) {
+            cout << "  [" << slice.start_time << "-" << slice.end_time << "] PID " << slice.pid << endl;
+        }
+        cout << "Disk Gantt Chart:\n";
+        for (const auto& slice : result.disk_gantt) {
+            cout << "  [" << slice.start_time << "-" << slice.end_time << "] PID " << slice.pid << endl;
+        }
+
+        cout << "\n" << setw(6) << "PID" << setw(13) << "Transaction" << setw(6) << "CPU" << setw(12) << "Ready Wait"
+             << setw(11) << "Disk Wait" << setw(10) << "IPC Wait" << setw(12) << "Turnaround" << endl;
+        cout << string(70, '-') << endl;
+        vector<size_t> finished;
+        for (size_t i = 0; i < processes.size(); i++) {
+            const KernelProcessMetrics& m = result.processes[i];
+            cout << setw(6) << processes[i].pid << setw(13) << transactions[i].id << setw(6) << m.cpu_time
+                 << setw(12) << m.ready_wait_time << setw(11) << m.disk_wait_time << setw(10) << m.ipc_wait_time;
+            if (m.completion_time >= 0) {
+                cout << setw(12) << m.turnaround_time << endl;
+                process_table->setWaitingTime(processes[i].pid, (int)m.ready_wait_time);
+                process_table->setTurnaroundTime(processes[i].pid, (int)m.turnaround_time);
+                finished.push_back(i);
+            } else {
+                cout << setw(12) << "blocked" << endl;
+            }
+        }
+
+        // Execute the finished transactions in completion order
+        stable_sort(finished.begin(), finished.end(), [&result](size_t a, size_t b) {
+            return result.processes[a].completion_time < result.processes[b].completion_time;
+        });
+        for (size_t i : finished) {
+            const ScheduledTransaction& t = transactions[i];
+            transaction_manager->submitTransaction(t.id, t.action, t.account_id, t.amount).get();
+        }
+
+        logger().flush();
+        cout << "\n=== KERNEL LOOP METRICS ===" << endl;
+        cout << "Completed Processes: " << result.completed << " / " << processes.size() << endl;
+        cout << "Average Waiting Time (ready queue): " << fixed << setprecision(2) << result.avg_waiting_time << " units" << endl;
+        cout << "Average Turnaround Time: " << result.avg_turnaround_time << " units" << endl;
+        cout << "Average Response Time: " << result.avg_response_time << " units" << endl;
+        cout << "Throughput: " << setprecision(4) << result.throughput << " processes/unit" << endl;
+        cout << "CPU Utilization: " << setprecision(2) << result.cpu_utilization << "%" << endl;
+        cout << "Disk Utilization: " << result.disk_utilization << "%" << endl;
+        cout << "CPU/Disk Overlap: " << result.overlap << " units (serial time would be "
+             << result.cpu_busy + result.disk_busy << ", makespan " << result.makespan << ")" << endl;
+        cout << "Context Switches: " << result.context_switches << ", Disk Requests: " << result.disk_requests
+             << ", Messages: " << result.messages << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+
+        process_table->displayProcessTable();
+    }
+
+    // Schedule the workload on cpu_count cores, each with its own run queue
+    // running the chosen policy, and compare against a single CPU
+    void simulateMultiCore(int policy_index, int cpu_count, const vector<ScheduledTransaction>& transactions) {
+        auto factory = [this, policy_index]() { return makePolicy(policy_index); };
+        if (!factory()) {
+            cout << "[ERROR] Invalid policy!" << endl;
+            return;
+        }
+        cpu_count = max(1, min(cpu_count, 64));
+        cout << "\n=== MULTI-CORE SCHEDULING: " << factory()->name() << " on " << cpu_count
+             << " CPUs (Context Switch = " << context_switch_cost << ") ===\n";
+
+        vector<SchedulerJob> jobs;
+        for (const auto& transaction : transactions) {
+            int pid = process_table->createProcess(transaction.id, transaction.arrival_time, transaction.burst_time);
+            process_table->setAffinity(pid, transaction.affinity);
+            jobs.push_back({pid, transaction.arrival_time, transaction.burst_time, transaction.priority,
+                            process_table->getAffinity(pid)});
+        }
+        if (jobs.empty()) {
+            cout << "No transactions to schedule" << endl;
+            return;
+        }
+
+        MultiCoreEngine engine(cpu_count, context_switch_cost, 1, 4 * time_quantum);
+        MultiCoreResult result = engine.run(jobs, factory);
+        MultiCoreResult single = MultiCoreEngine(1, context_switch_cost).run(jobs, factory, false);
+
+        logger().flush();
+        for (int cpu = 0; cpu < cpu_count; cpu++) {
+            cout << "\nCPU " << cpu << " Gantt Chart:";
+            for (const auto& slice : result.cores[cpu].gantt) {
+                cout << " [" << slice.start_time << "-" << slice.end_time << "] PID " << slice.pid;
+            }
+            cout << endl;
+        }
+
+        cout << "\n" << setw(6) << "CPU" << setw(12) << "Busy Time" << setw(14) << "Utilization"
+             << setw(12) << "Dispatches" << setw(10) << "Switches" << endl;
+        cout << string(54, '-') << endl;
+        for (int cpu = 0; cpu < cpu_count; cpu++) {
+            const CoreStats& core = result.cores[cpu];
+            cout << setw(6) << cpu << setw(12) << core.busy_time << setw(13) << fixed << setprecision(2)
+                 << core.utilization << "%" << setw(12) << core.dispatches << setw(10) << core.context_switches << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+
+        for (size_t i = 0; i < jobs.size(); i++) {
+            process_table->setWaitingTime(jobs[i].pid, (int)result.summary.jobs[i].waiting_time);
+            process_table->setTurnaroundTime(jobs[i].pid, (int)result.summary.jobs[i].turnaround_time);
+        }
+
+        // Execute the transactions in the order the schedule completes them
+        cout << endl;
+        for (size_t job : result.summary.completion_order) {
+            const ScheduledTransaction& t = transactions[job];
+            transaction_manager->submitTransaction(t.id, t.action, t.account_id, t.amount, jobs[job].pid).get();
+        }
+
+        logger().flush();
+        cout << "\n=== MULTI-CORE METRICS ===" << endl;
+        cout << left << setw(26) << "Metric" << right << setw(12) << "1 CPU" << setw(12) << (to_string(cpu_count) + " CPUs") << endl;
+        cout << string(50, '-') << endl;
+        cout << fixed << setprecision(2);
+        cout << left << setw(26) << "Makespan" << right << setw(12) << single.summary.makespan
+             << setw(12) << result.summary.makespan << endl;
+        cout << left << setw(26) << "Average Waiting Time" << right << setw(12) << single.summary.avg_waiting_time
+             << setw(12) << result.summary.avg_waiting_time << endl;
+        cout << left << setw(26) << "Average Turnaround Time" << right << setw(12) << single.summary.avg_turnaround_time
+             << setw(12) << result.summary.avg_turnaround_time << endl;
+        cout << left << setw(26) << "Average Response Time" << right << setw(12) << single.summary.avg_response_time
+             << setw(12) << result.summary.avg_response_time << endl;
+        cout << left << setw(26) << "CPU Utilization (%)" << right << setw(12) << single.summary.cpu_utilization
+             << setw(12) << result.summary.cpu_utilization << endl;
+        cout << left << setw(26) << "Context Switches" << right << setw(12) << single.summary.context_switches
+             << setw(12) << result.summary.context_switches << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+        cout << "Migrations: " << result.migrations << ", Steals: " << result.steals
+             << ", Balancer Moves: " << result.balance_moves << endl;
+        if (result.summary.makespan > 0) {
+            cout << "Speedup: " << fixed << setprecision(2) << (double)single.summary.makespan / result.summary.makespan
+                 << "x" << endl;
+            cout.unsetf(ios::fixed);
+            cout << setprecision(6);
+        }
+
+        process_table->displayProcessTable();
+    }
+
+    // Run every policy over the same workload (schedule only, no execution)
+    void comparePolicies(const vector<ScheduledTransaction>& transactions) {
+        vector<SchedulerJob> jobs;
+        for (size_t i = 0; i < transactions.size(); i++) {
+            jobs.push_back({(int)i + 1, transactions[i].arrival_time, transactions[i].burst_time, transactions[i].priority});
+        }
+
+        cout << "\n=== CPU SCHEDULING POLICY COMPARISON (Context Switch = " << context_switch_cost << ") ===" << endl;
+        cout << left << setw(40) << "Policy" << right << setw(10) << "Avg Wait" << setw(10) << "Avg TAT"
+             << setw(10) << "Avg Resp" << setw(12) << "Throughput" << setw(10) << "CPU %" << setw(6) << "CS" << endl;
+        cout << string(98, '-') << endl;
+        SchedulingEngine engine(context_switch_cost);
+        for (int i = 0; i < POLICY_COUNT; i++) {
+            unique_ptr<SchedulingPolicy> policy = makePolicy(i);
+            SchedulingResult result = engine.run(jobs, *policy, false);
+            cout << left << setw(40) << policy->name() << right << fixed << setprecision(2)
+                 << setw(10) << result.avg_waiting_time << setw(10) << result.avg_turnaround_time
+                 << setw(10) << result.avg_response_time << setw(12) << setprecision(4) << result.throughput
+                 << setw(10) << setprecision(2) << result.cpu_utilization << setw(6) << result.context_switches << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+
+// --- Memory Management ---
+struct PagingStats {
+    unsigned long long accesses = 0;
+    unsigned long long hits = 0;
+    unsigned long long faults = 0;
+    unsigned long long evictions = 0;
+
+    double hitRate() const {
+        return accesses ? (double)hits / accesses * 100 : 0;
+    }
+
+    double faultRate() const {
+        return accesses ? (double)faults / accesses * 100 : 0;
+    }
+};
+
+// Common interface for page replacement algorithms. A policy only tracks
+// which pages are resident; MemoryManager keeps page contents and counters.
+class PageReplacementPolicy {
+public:
+    static constexpr int NO_PAGE = INT_MIN;
+
+    virtual ~PageReplacementPolicy() {}
+    virtual string name() const = 0;
+    virtual void reset(size_t frame_count) = 0;
+    // Future knowledge of the reference string (only OPT uses it)
+    virtual void prepare(const vector<int>&) {}
+    // Returns true on a hit; on a fault that replaces a page, evicted is the victim
+    virtual bool access(int page_id, int& evicted) = 0;
+    // Resident pages, next replacement candidate first where the policy has an order
+    virtual vector<int> residentPages() const = 0;
+};
+
+// LRU: hash map from page to frame plus an intrusive doubly linked list
+// threaded through the frame array (head = most recently used). Lookup,
+// promotion and eviction are all O(1).
+class LRUPolicy : public PageReplacementPolicy {
+private:
+    static const int NONE = -1;
+
+    struct PageFrame {
+        int page_id;
+        int prev;
+        int next;
+    };
+
+    vector<PageFrame> frames;
+    unordered_map<int, int> page_table; // page_id -> frame index
+    size_t frame_count = 1;
+    int head = NONE; // Most recently used
+    int tail = NONE; // Least recently used
+
+    void unlink(int frame) {
+        PageFrame& f = frames[frame];
+        if (f.prev != NONE) frames[f.prev].next = f.next; else head = f.next;
+        if (f.next != NONE) frames[f.next].prev = f.prev; else tail = f.prev;
+    }
+
+    void pushFront(int frame) {
+        frames[frame].prev = NONE;
+        frames[frame].next = head;
+        if (head != NONE) frames[head].prev = frame;
+        head = frame;
+        if (tail == NONE) tail = frame;
+    }
+
+public:
+    string name() const override { return "LRU"; }
+
+    void reset(size_t count) override {
+        frame_count = count;
+        frames.clear();
+        frames.reserve(count);
+        page_table.clear();
+        page_table.reserve(count * 2);
+        head = tail = NONE;
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        auto it = page_table.find(page_id);
+        if (it != page_table.end()) {
+            if (it->second != head) {
+                unlink(it->second);
+                pushFront(it->second);
+            }
+            return true;
+        }
+
+        int frame;
+        if (frames.size() < frame_count) {
+            frame = (int)frames.size();
+            frames.push_back({page_id, NONE, NONE});
+        } else {
+            frame = tail; // Evict the least recently used page
+            unlink(frame);
+            evicted = frames[frame].page_id;
+            page_table.erase(evicted);
+            frames[frame].page_id = page_id;
+        }
+        page_table[page_id] = frame;
+        pushFront(frame);
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        vector<int> pages;
+        for (int frame = tail; frame != NONE; frame = frames[frame].prev) {
+            pages.push_back(frames[frame].page_id);
+        }
+        return pages;
+    }
+};
+
+// FIFO: evict the page that has been resident longest
+class FIFOPolicy : public PageReplacementPolicy {
+private:
+    deque<int> load_order;
+    unordered_set<int> resident;
+    size_t frame_count = 1;
+
+public:
+    string name() const override { return "FIFO"; }
+
+    void reset(size_t count) override {
+        frame_count = count;
+        load_order.clear();
+        resident.clear();
+        resident.reserve(count * 2);
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        if (resident.count(page_id)) {
+            return true;
+        }
+        if (load_order.size() >= frame_count) {
+            evicted = load_order.front();
+            load_order.pop_front();
+            resident.erase(evicted);
+        }
+        load_order.push_back(page_id);
+        resident.insert(page_id);
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        return vector<int>(load_order.begin(), load_order.end());
+    }
+};
+
+// Belady's OPT: evict the resident page whose next use lies furthest in the
+// future. prepare() precomputes the next-use index of every reference in one
+// backward pass; resident pages sit in an ordered set keyed by next use.
+// References beyond the prepared trace are treated as never used again.
+class OptimalPolicy : public PageReplacementPolicy {
+private:
+    static constexpr long long NEVER = LLONG_MAX;
+
+    vector<int> trace;
+    vector<long long> next_use;
+    size_t position = 0;
+    size_t frame_count = 1;
+    unordered_map<int, long long> resident; // page -> next use
+    set<pair<long long, int>> by_next_use;
+
+public:
+    string name() const override { return "OPT"; }
+
+    void reset(size_t count) override {
+        frame_count = count;
+        position = 0;
+        resident.clear();
+        by_next_use.clear();
+    }
+
+    void prepare(const vector<int>& references) override {
+        trace = references;
+        next_use.assign(trace.size(), NEVER);
+        unordered_map<int, long long> seen;
+        for (size_t i = trace.size(); i-- > 0;) {
+            auto it = seen.find(trace[i]);
+            if (it != seen.end()) {
+                next_use[i] = it->second;
+            }
+            seen[trace[i]] = (long long)i;
+        }
+        position = 0;
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        long long next = NEVER;
+        if (position < trace.size() && trace[position] == page_id) {
+            next = next_use[position];
+        }
+        position++;
+
+        auto it = resident.find(page_id);
+        if (it != resident.end()) {
+            by_next_use.erase({it->second, page_id});
+            it->second = next;
+            by_next_use.insert({next, page_id});
+            return true;
+        }
+        if (resident.size() >= frame_count) {
+            auto victim = prev(by_next_use.end());
+            evicted = victim->second;
+            resident.erase(evicted);
+            by_next_use.erase(victim);
+        }
+        resident[page_id] = next;
+        by_next_use.insert({next, page_id});
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        vector<int> pages;
+        for (auto it = by_next_use.rbegin(); it != by_next_use.rend(); ++it) {
+            pages.push_back(it->second);
+        }
+        return pages;
+    }
+};
+
+// Clock (second chance): frames form a circle; the hand clears reference
+// bits until it finds a page that was not referenced since its last pass.
+class ClockPolicy : public PageReplacementPolicy {
+private:
+    vector<int> frame_page;
+    vector<char> referenced;
+    unordered_map<int, size_t> page_table;
+    size_t frame_count = 1;
+    size_t hand = 0;
+
+public:
+    string name() const override { return "Clock"; }
+
+    void reset(size_t count) override {
+        frame_count = count;
+        frame_page.clear();
+        referenced.clear();
+        page_table.clear();
+        page_table.reserve(count * 2);
+        hand = 0;
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        auto it = page_table.find(page_id);
+        if (it != page_table.end()) {
+            referenced[it->second] = 1;
+            return true;
+        }
+        if (frame_page.size() < frame_count) {
+            page_table[page_id] = frame_page.size();
+            frame_page.push_back(page_id);
+            referenced.push_back(1);
+            return false;
+        }
+        while (referenced[hand]) {
+            referenced[hand] = 0; // Second chance
+            hand = (hand + 1) % frame_count;
+        }
+        evicted = frame_page[hand];
+        page_table.erase(evicted);
+        frame_page[hand] = page_id;
+        referenced[hand] = 1;
+        page_table[page_id] = hand;
+        hand = (hand + 1) % frame_count;
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        vector<int> pages;
+        for (size_t i = 0; i < frame_page.size(); i++) {
+            pages.push_back(frame_page[(hand + i) % frame_page.size()]);
+        }
+        return pages;
+    }
+};
+
+// LFU with O(1) operations: one list per use count (front = most recent),
+// ties within the lowest count are broken by least recent use
+class LFUPolicy : public PageReplacementPolicy {
+private:
+    struct Entry {
+        unsigned long long count;
+        list<int>::iterator position;
+    };
+
+    unordered_map<int, Entry> entries;
+    unordered_map<unsigned long long, list<int>> buckets;
+    unsigned long long min_count = 0;
+    size_t frame_count = 1;
+
+public:
+    string name() const override { return "LFU"; }
+
+    void reset(size_t count) override {
+        frame_count = count;
+        entries.clear();
+        entries.reserve(count * 2);
+        buckets.clear();
+        min_count = 0;
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        auto it = entries.find(page_id);
+        if (it != entries.end()) {
+            Entry& entry = it->second;
+            list<int>& bucket = buckets[entry.count];
+            bucket.erase(entry.position);
+            if (bucket.empty()) {
+                buckets.erase(entry.count);
+                if (min_count == entry.count) min_count++;
+            }
+            entry.count++;
+            list<int>& next_bucket = buckets[entry.count];
+            next_bucket.push_front(page_id);
+            entry.position = next_bucket.begin();
+            return true;
+        }
+        if (entries.size() >= frame_count) {
+            list<int>& bucket = buckets[min_count];
+            evicted = bucket.back();
+            bucket.pop_back();
+            if (bucket.empty()) buckets.erase(min_count);
+            entries.erase(evicted);
+        }
+        list<int>& bucket = buckets[1];
+        bucket.push_front(page_id);
+        entries[page_id] = {1, bucket.begin()};
+        min_count = 1;
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        vector<pair<unsigned long long, int>> pages;
+        for (const auto& entry : entries) {
+            pages.push_back({entry.second.count, entry.first});
+        }
+        sort(pages.begin(), pages.end());
+        vector<int> result;
+        for (const auto& page : pages) {
+            result.push_back(page.second);
+        }
+        return result;
+    }
+};
+
+// ARC (Adaptive Replacement Cache, Megiddo & Modha): T1 holds pages seen once
+// recently, T2 pages seen at least twice; ghost lists B1/B2 remember recent
+// evictions from each and steer the target size p of T1.
+class ARCPolicy : public PageReplacementPolicy {
+private:
+    enum ListId { T1, T2, B1, B2 };
+
+    struct Entry {
+        ListId where;
+        list<int>::iterator position;
+    };
+
+    list<int> lists[4]; // Front = most recently used
+    unordered_map<int, Entry> entries;
+    size_t capacity = 1;
+    size_t target_t1 = 0; // p
+
+    void moveTo(int page_id, ListId target) {
+        Entry& entry = entries[page_id];
+        lists[entry.where].erase(entry.position);
+        lists[target].push_front(page_id);
+        entry.where = target;
+        entry.position = lists[target].begin();
+    }
+
+    void dropLru(ListId from) {
+        int page_id = lists[from].back();
+        lists[from].pop_back();
+        entries.erase(page_id);
+    }
+
+    // Evict the LRU page of T1 or T2 into the matching ghost list
+    int replace(bool hit_in_b2) {
+        size_t t1 = lists[T1].size();
+        ListId from = (t1 >= 1 && ((hit_in_b2 && t1 == target_t1) || t1 > target_t1)) ? T1 : T2;
+        int victim = lists[from].back();
+        moveTo(victim, from == T1 ? B1 : B2);
+        return victim;
+    }
+
+    bool cacheFull() const {
+        return lists[T1].size() + lists[T2].size() >= capacity;
+    }
+
+public:
+    string name() const override { return "ARC"; }
+
+    void reset(size_t count) override {
+        capacity = count;
+        for (auto& l : lists) {
+            l.clear();
+        }
+        entries.clear();
+        entries.reserve(count * 4);
+        target_t1 = 0;
+    }
+
+    bool access(int page_id, int& evicted) override {
+        evicted = NO_PAGE;
+        auto it = entries.find(page_id);
+        if (it != entries.end() && (it->second.where == T1 || it->second.where == T2)) {
+            moveTo(page_id, T2);
+            return true;
+        }
+
+        if (it != entries.end()) {
+            bool in_b1 = it->second.where == B1;
+            size_t b1 = lists[B1].size(), b2 = lists[B2].size();
+            if (in_b1) {
+                target_t1 = min(capacity, target_t1 + max<size_t>(b2 / b1, 1));
+            } else {
+                size_t delta = max<size_t>(b1 / b2, 1);
+                target_t1 = target_t1 > delta ? target_t1 - delta : 0;
+            }
+            if (cacheFull()) {
+                evicted = replace(!in_b1);
+            }
+            moveTo(page_id, T2);
+            return false;
+        }
+
+        size_t l1 = lists[T1].size() + lists[B1].size();
+        size_t total = l1 + lists[T2].size() + lists[B2].size();
+        if (l1 >= capacity) {
+            if (lists[T1].size() < capacity) {
+                dropLru(B1);
+                if (cacheFull()) evicted = replace(false);
+            } else {
+                evicted = lists[T1].back();
+                dropLru(T1);
+            }
+        } else if (total >= capacity) {
+            if (total >= 2 * capacity) {
+                dropLru(B2);
+            }
+            if (cacheFull()) evicted = replace(false);
+        }
+        lists[T1].push_front(page_id);
+        entries[page_id] = {T1, lists[T1].begin()};
+        return false;
+    }
+
+    vector<int> residentPages() const override {
+        vector<int> pages(lists[T1].rbegin(), lists[T1].rend());
+        pages.insert(pages.end(), lists[T2].rbegin(), lists[T2].rend());
+        return pages;
+    }
+};
+
+class MemoryManager {
+private:
+    unique_ptr<PageReplacementPolicy> policy;
+    unordered_map<int, string> page_data;
+    size_t frame_count;
+    PagingStats stats;
+
+public:
+    static const int POLICY_COUNT = 6;
+
+    // Algorithms in menu order
+    static unique_ptr<PageReplacementPolicy> makePolicy(int index) {
+        switch (index) {
+        case 0: return make_unique<LRUPolicy>();
+        case 1: return make_unique<FIFOPolicy>();
+        case 2: return make_unique<OptimalPolicy>();
+        case 3: return make_unique<ClockPolicy>();
+        case 4: return make_unique<LFUPolicy>();
+        case 5: return make_unique<ARCPolicy>();
+        default: return nullptr;
+        }
+    }
+
+    explicit MemoryManager(size_t frames_available = 3) : policy(make_unique<LRUPolicy>()) {
+        setFrameCount(frames_available);
+    }
+
+    // Switching policy or frame count empties memory and clears the counters
+    void setPolicy(unique_ptr<PageReplacementPolicy> new_policy) {
+        policy = move(new_policy);
+        setFrameCount(frame_count);
+    }
+
+    void setFrameCount(size_t frames_available) {
+        frame_count = max<size_t>(1, frames_available);
+        policy->reset(frame_count);
+        page_data.clear();
+        stats = PagingStats();
+    }
+
+    size_t getFrameCount() const {
+        return frame_count;
+    }
+
+    string getPolicyName() const {
+        return policy->name();
+    }
+
+    // Give the policy the upcoming reference string (needed by OPT)
+    void planReferences(const vector<int>& references) {
+        policy->prepare(references);
+    }
+
+    void accessMemoryPage(int page_id, const string& data) {
+        bool hit = touchPage(page_id, true);
+        page_data[page_id] = data;
+        cout << "Accessed memory page: " << page_id << (hit ? " (hit)" : " (page fault)") << endl;
+    }
+
+    // Silent access for trace replay; returns true on a hit
+    bool touchPage(int page_id, bool verbose = false) {
+        int evicted;
+        bool hit = policy->access(page_id, evicted);
+        stats.accesses++;
+        if (hit) {
+            stats.hits++;
+        } else {
+            stats.faults++;
+        }
+        if (evicted != PageReplacementPolicy::NO_PAGE) {
+            stats.evictions++;
+            page_data.erase(evicted);
+            if (verbose) {
+                cout << "Removed page: " << evicted << endl;
+            }
+        }
+        return hit;
+    }
+
+    PagingStats replayTrace(const vector<int>& references) {
+        policy->prepare(references);
+        for (int page_id : references) {
+            touchPage(page_id);
+        }
+        return stats;
+    }
+
+    const PagingStats& getStats() const {
+        return stats;
+    }
+
+    void resetStats() {
+        stats = PagingStats();
+    }
+
+    // LRU faults for every frame count 1..max_frames in one pass. LRU is a
+    // stack algorithm: a reference hits with c frames exactly when its stack
+    // distance (distinct pages touched since its previous use, itself
+    // included) is at most c. Distances come from a Fenwick tree over the
+    // positions of each page's latest use, so the pass is O(n log n).
+    static vector<unsigned long long> lruFaultCurve(const vector<int>& references, size_t max_frames) {
+        size_t n = references.size();
+        vector<int> fenwick(n + 1, 0);
+        auto add = [&](size_t pos, int delta) {
+            for (size_t i = pos + 1; i <= n; i += i & (0 - i)) fenwick[i] += delta;
+        };
+        auto prefix = [&](size_t count) {
+            long long sum = 0;
+            for (size_t i = count; i > 0; i -= i & (0 - i)) sum += fenwick[i];
+            return sum;
+        };
+
+        vector<unsigned long long> distance_hist(max_frames + 1, 0);
+        unordered_map<int, size_t> last_use;
+        for (size_t i = 0; i < n; i++) {
+            auto it = last_use.find(references[i]);
+            if (it != last_use.end()) {
+                size_t distance = (size_t)(prefix(i) - prefix(it->second + 1)) + 1;
+                if (distance <= max_frames) distance_hist[distance]++;
+                add(it->second, -1);
+                it->second = i;
+            } else {
+                last_use[references[i]] = i;
+            }
+            add(i, 1);
+        }
+
+        vector<unsigned long long> faults(max_frames + 1, n);
+        unsigned long long hits = 0;
+        for (size_t c = 1; c <= max_frames; c++) {
+            hits += distance_hist[c];
+            faults[c] = n - hits;
+        }
+        return faults;
+    }
+
+    // Fault rate of every algorithm for frame counts min_frames..max_frames
+    static void compareAlgorithms(const vector<int>& references, size_t min_frames, size_t max_frames) {
+        min_frames = max<size_t>(1, min_frames);
+        max_frames = max(min_frames, max_frames);
+        vector<unsigned long long> lru_faults = lruFaultCurve(references, max_frames);
+        double n = max<size_t>(1, references.size());
+
+        cout << "\n=== PAGE REPLACEMENT COMPARISON (" << references.size() << " references, fault rate %) ===" << endl;
+        cout << setw(8) << "Frames";
+        for (int i = 0; i < POLICY_COUNT; i++) {
+            cout << setw(10) << makePolicy(i)->name();
+        }
+        cout << endl << string(8 + 10 * POLICY_COUNT, '-') << endl;
+
+        cout << fixed << setprecision(1);
+        for (size_t frames = min_frames; frames <= max_frames; frames++) {
+            cout << setw(8) << frames << setw(10) << lru_faults[frames] / n * 100; // One-pass stack distance
+            for (int i = 1; i < POLICY_COUNT; i++) {
+                unique_ptr<PageReplacementPolicy> policy = makePolicy(i);
+                policy->reset(frames);
+                policy->prepare(references);
+                unsigned long long faults = 0;
+                int evicted;
+                for (int page_id : references) {
+                    if (!policy->access(page_id, evicted)) faults++;
+                }
+                cout << setw(10) << faults / n * 100;
+            }
+            cout << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    void displayMemoryMap() {
+        cout << "\nMemory Map (" << policy->name() << ", next victim first):" << endl;
+        for (int page_id : policy->residentPages()) {
+            cout << "Page " << page_id << ": " << page_data[page_id] << endl;
+        }
+    }
+
+    void displayStats() {
+        cout << "\n=== PAGING STATISTICS (" << policy->name() << ", " << frame_count << " frames) ===" << endl;
+        cout << "Accesses: " << stats.accesses << endl;
+        cout << "Hits: " << stats.hits << endl;
+        cout << "Page Faults: " << stats.faults << endl;
+        cout << "Evictions: " << stats.evictions << endl;
+        cout << "Hit Rate: " << fixed << setprecision(2) << stats.hitRate() << "%" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+
+// --- Virtual Memory ---
+// Address translation for simulated processes. Each process gets a radix
+// page table (9 index bits per level, 4 KiB pages) hanging off its PCB, and
+// all processes share one pool of physical frames that is filled on demand
+// and recycled with the clock algorithm. A set-associative TLB tagged with
+// the PID (used as the ASID) sits in front of the page walk, so switching
+// between processes needs no TLB flush.
+class PageTable {
+public:
+    static constexpr int PAGE_BITS = 12;
+    static constexpr int LEVEL_BITS = 9;
+    static constexpr int MAX_LEVELS = 4;           // 48-bit virtual addresses
+    static constexpr uint32_t PRESENT = 1u << 31;  // Leaf entries hold PRESENT | frame
+
+private:
+    static const size_t ENTRIES = size_t(1) << LEVEL_BITS;
+
+    int levels;
+    // Node n occupies entries [n * ENTRIES, (n + 1) * ENTRIES). Interior
+    // entries hold the child's node number; 0 means none (node 0 is the root).
+    vector<uint32_t> entries;
+    size_t resident = 0;
+
+    static size_t indexAt(uint64_t vpn, int level) {
+        return (size_t)(vpn >> (level * LEVEL_BITS)) & (ENTRIES - 1);
+    }
+
+    // Leaf entry for vpn, allocating missing interior nodes
+    uint32_t& leaf(uint64_t vpn) {
+        size_t node = 0;
+        for (int level = levels - 1; level > 0; level--) {
+            size_t index = node * ENTRIES + indexAt(vpn, level);
+            if (!entries[index]) {
+                entries[index] = (uint32_t)(entries.size() / ENTRIES);
+                entries.resize(entries.size() + ENTRIES, 0);
+            }
+            node = entries[index];
+        }
+        return entries[node * ENTRIES + indexAt(vpn, 0)];
+    }
+
+public:
+    explicit PageTable(int level_count) : levels(min(max(level_count, 1), MAX_LEVELS)), entries(ENTRIES, 0) {}
+
+    int levelCount() const {
+        return levels;
+    }
+
+    // Virtual page numbers below this limit are translatable
+    uint64_t pageLimit() const {
+        return uint64_t(1) << (LEVEL_BITS * levels);
+    }
+
+    // Hardware walk: the leaf entry for vpn, or nullptr when an interior node
+    // is missing. reads counts the table entries read on the way.
+    const uint32_t* walk(uint64_t vpn, int& reads) const {
+        size_t node = 0;
+        for (int level = levels - 1; level > 0; level--) {
+            reads++;
+            uint32_t child = entries[node * ENTRIES + indexAt(vpn, level)];
+            if (!child) {
+                return nullptr;
+            }
+            node = child;
+        }
+        reads++;
+        return &entries[node * ENTRIES + indexAt(vpn, 0)];
+    }
+
+    void map(uint64_t vpn, uint32_t frame) {
+        uint32_t& entry = leaf(vpn);
+        if (!(entry & PRESENT)) {
+            resident++;
+        }
+        entry = PRESENT | frame;
+    }
+
+    void unmap(uint64_t vpn) {
+        int reads = 0;
+        const uint32_t* entry = walk(vpn, reads);
+        if (entry && (*entry & PRESENT)) {
+            entries[entry - entries.data()] = 0;
+            resident--;
+        }
+    }
+
+    size_t residentPages() const {
+        return resident;
+    }
+
+    size_t nodeCount() const {
+        return entries.size() / ENTRIES;
+    }
+
+    size_t bytes() const {
+        return entries.size() * sizeof(uint32_t);
+    }
+};
+
+// Set-associative TLB with LRU replacement inside each set. Keys combine the
+// ASID and the virtual page number; key 0 marks an empty way (PIDs start at 1).
+class TLB {
+private:
+    static const int KEY_VPN_BITS = PageTable::LEVEL_BITS * PageTable::MAX_LEVELS;
+
+    struct Entry {
+        uint64_t key;
+        uint64_t last_use;
+        uint32_t frame;
+    };
+
+    vector<Entry> entries;
+    size_t set_mask = 0;
+    size_t ways = 1;
+    uint64_t clock = 0;
+
+    Entry* setOf(uint64_t key) {
+        // Mixing the ASID into the index keeps processes that use the same
+        // page numbers from competing for one set
+        return &entries[(size_t)((key ^ (key >> KEY_VPN_BITS)) & set_mask) * ways];
+    }
+
+public:
+    TLB(size_t set_count, size_t way_count) {
+        size_t sets = 1;
+        while (sets < set_count) {
+            sets <<= 1;
+        }
+        set_mask = sets - 1;
+        ways = max<size_t>(1, way_count);
+        entries.assign(sets * ways, Entry{0, 0, 0});
+    }
+
+    static uint64_t keyOf(int asid, uint64_t vpn) {
+        return ((uint64_t)asid << KEY_VPN_BITS) | vpn;
+    }
+
+    bool lookup(uint64_t key, uint32_t& frame) {
+        Entry* set = setOf(key);
+        for (size_t way = 0; way < ways; way++) {
+            if (set[way].key == key) {
+                set[way].last_use = ++clock;
+                frame = set[way].frame;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void insert(uint64_t key, uint32_t frame) {
+        Entry* set = setOf(key);
+        Entry* victim = set;
+        for (size_t way = 0; way < ways; way++) {
+            if (set[way].key == 0) {
+                victim = &set[way];
+                break;
+            }
+            if (set[way].last_use < victim->last_use) {
+                victim = &set[way];
+            }
+        }
+        *victim = Entry{key, ++clock, frame};
+    }
+
+    // Shootdown of one translation after its page was evicted
+    void invalidate(uint64_t key) {
+        Entry* set = setOf(key);
+        for (size_t way = 0; way < ways; way++) {
+            if (set[way].key == key) {
+                set[way].key = 0;
+            }
+        }
+    }
+
+    void flushAsid(int asid) {
+        for (Entry& entry : entries) {
+            if (entry.key && (int)(entry.key >> KEY_VPN_BITS) == asid) {
+                entry.key = 0;
+            }
+        }
+    }
+
+    size_t setCount() const {
+        return set_mask + 1;
+    }
+
+    size_t wayCount() const {
+        return ways;
+    }
+};
+
+struct VirtualMemoryConfig {
+    size_t frames = 512;
+    size_t tlb_sets = 16;
+    size_t tlb_ways = 4;
+    int levels = PageTable::MAX_LEVELS;
+    // Cost model for the effective access time
+    double tlb_ns = 1;
+    double memory_ns = 100;
+    double fault_ns = 8000000;     // Reading the missing page from disk
+    double writeback_ns = 8000000; // Writing a dirty victim back first
+};
+
+struct TranslationStats {
+    uint64_t references = 0;
+    uint64_t tlb_hits = 0;
+    uint64_t walk_reads = 0;       // Page table entries read by walks
+    uint64_t page_faults = 0;
+    uint64_t evictions = 0;
+    uint64_t writebacks = 0;
+    uint64_t invalid = 0;          // Outside the address space, or no address space
+
+    uint64_t tlbMisses() const {
+        return references - tlb_hits;
+    }
+
+    double tlbHitRate() const {
+        return references ? (double)tlb_hits / references * 100 : 0;
+    }
+
+    double readsPerWalk() const {
+        return tlbMisses() ? (double)walk_reads / tlbMisses() : 0;
+    }
+};
+
+// One reference in an address trace; also the binary trace record
+struct MemoryReference {
+    static const uint32_t WRITE = 1;
+
+    uint64_t address;
+    uint32_t pid;
+    uint32_t flags;
+};
+
+static_assert(sizeof(MemoryReference) == 16, "address trace layout is part of the file format");
+
+class VirtualMemory {
+private:
+    struct Frame {
+        PageTable* owner = nullptr;
+        uint64_t vpn = 0;
+        int pid = 0;
+    };
+
+    ProcessTable* process_table;
+    VirtualMemoryConfig config;
+    TLB tlb;
+    uint64_t page_limit;
+    vector<Frame> frames;
+    vector<uint8_t> referenced;    // Set on every access, cleared by the clock hand
+    vector<uint8_t> dirty;
+    vector<uint32_t> free_frames;
+    size_t hand = 0;
+    // Keeps each table alive while its pages occupy frames, even if the PCB let go
+    unordered_map<int, shared_ptr<PageTable>> spaces;
+    TranslationStats stats;
+
+    uint32_t allocateFrame() {
+        if (!free_frames.empty()) {
+            uint32_t frame = free_frames.back();
+            free_frames.pop_back();
+            return frame;
+        }
+        while (true) {
+            uint32_t frame = (uint32_t)hand;
+            hand = (hand + 1) % frames.size();
+            if (referenced[frame]) {
+                referenced[frame] = 0; // Second chance
+                continue;
+            }
+            Frame& victim = frames[frame];
+            victim.owner->unmap(victim.vpn);
+            tlb.invalidate(TLB::keyOf(victim.pid, victim.vpn));
+            stats.evictions++;
+            if (dirty[frame]) {
+                stats.writebacks++;
+                dirty[frame] = 0;
+            }
+            return frame;
+        }
+    }
+
+    // TLB miss: walk the page table, loading the page on a fault
+    bool walk(int pid, uint64_t vpn, uint64_t key, uint32_t& frame) {
+        PageTable* table = process_table->pageTable(pid);
+        if (!table) {
+            return false;
+        }
+        int reads = 0;
+        const uint32_t* entry = table->walk(vpn, reads);
+        stats.walk_reads += reads;
+        if (entry && (*entry & PageTable::PRESENT)) {
+            frame = *entry & ~PageTable::PRESENT;
+        } else {
+            stats.page_faults++;
+            frame = allocateFrame();
+            table->map(vpn, frame);
+            frames[frame] = Frame{table, vpn, pid};
+        }
+        tlb.insert(key, frame);
+        return true;
+    }
+
+public:
+    explicit VirtualMemory(ProcessTable* table, const VirtualMemoryConfig& vm_config = VirtualMemoryConfig())
+        : process_table(table), config(vm_config), tlb(vm_config.tlb_sets, vm_config.tlb_ways) {
+        config.frames = min<size_t>(max<size_t>(1, config.frames), PageTable::PRESENT - 1);
+        config.levels = PageTable(config.levels).levelCount();
+        page_limit = PageTable(config.levels).pageLimit();
+        frames.resize(config.frames);
+        referenced.assign(config.frames, 0);
+        dirty.assign(config.frames, 0);
+        free_frames.reserve(config.frames);
+        for (size_t frame = config.frames; frame-- > 0;) {
+            free_frames.push_back((uint32_t)frame);
+        }
+    }
+
+    ~VirtualMemory() {
+        while (!spaces.empty()) {
+            detach(spaces.begin()->first);
+        }
+    }
+
+    VirtualMemory(const VirtualMemory&) = delete;
+    VirtualMemory& operator=(const VirtualMemory&) = delete;
+
+    // Give a live process a fresh, empty address space
+    bool attach(int pid) {
+        detach(pid); // Anything left by an earlier process with this PID
+        auto table = make_shared<PageTable>(config.levels);
+        if (!process_table->setPageTable(pid, table)) {
+            return false;
+        }
+        spaces[pid] = move(table);
+        return true;
+    }
+
+    // Free the process's frames and TLB entries
+    void detach(int pid) {
+        auto it = spaces.find(pid);
+        if (it == spaces.end()) {
+            return;
+        }
+        PageTable* table = it->second.get();
+        for (uint32_t frame = 0; frame < frames.size(); frame++) {
+            if (frames[frame].owner == table) {
+                frames[frame] = Frame();
+                referenced[frame] = 0;
+                dirty[frame] = 0;
+                free_frames.push_back(frame);
+            }
+        }
+        tlb.flushAsid(pid);
+        if (process_table->pageTable(pid) == table) {
+            process_table->setPageTable(pid, nullptr);
+        }
+        spaces.erase(it);
+    }
+
+    // Returns false for addresses outside the address space and for processes
+    // without one
+    bool translate(int pid, uint64_t address, bool write, uint64_t& physical) {
+        uint64_t vpn = address >> PageTable::PAGE_BITS;
+        uint64_t key = TLB::keyOf(pid, vpn);
+        uint32_t frame;
+        if (vpn >= page_limit) {
+            stats.invalid++;
+            return false;
+        }
+        if (tlb.lookup(key, frame)) {
+            stats.tlb_hits++;
+        } else if (!walk(pid, vpn, key, frame)) {
+            stats.invalid++;
+            return false;
+        }
+        stats.references++;
+        referenced[frame] = 1;
+        if (write) {
+            dirty[frame] = 1;
+        }
+        physical = ((uint64_t)frame << PageTable::PAGE_BITS) | (address & ((uint64_t(1) << PageTable::PAGE_BITS) - 1));
+        return true;
+    }
+
+    TranslationStats replay(const vector<MemoryReference>& references) {
+        uint64_t physical;
+        for (const MemoryReference& reference : references) {
+            translate((int)reference.pid, reference.address, reference.flags & MemoryReference::WRITE, physical);
+        }
+        return stats;
+    }
+
+    const TranslationStats& getStats() const {
+        return stats;
+    }
+
+    const VirtualMemoryConfig& getConfig() const {
+        return config;
+    }
+
+    // Average cost of a TLB miss in ns
+    double pageWalkCost() const {
+        return stats.readsPerWalk() * config.memory_ns;
+    }
+
+    // Average ns per reference: the TLB probe and the data access, page table
+    // reads on TLB misses and, optionally, page fault service
+    double effectiveAccessTime(bool with_faults = true) const {
+        if (!stats.references) {
+            return 0;
+        }
+        double total = stats.references * (config.tlb_ns + config.memory_ns) + stats.walk_reads * config.memory_ns;
+        if (with_faults) {
+            total += stats.page_faults * config.fault_ns + stats.writebacks * config.writeback_ns;
+        }
+        return total / stats.references;
+    }
+
+    void displayStats() const {
+        cout << "\n=== VIRTUAL MEMORY (" << config.levels << "-level page tables, " << config.frames << " frames, TLB "
+             << tlb.setCount() << " sets x " << tlb.wayCount() << " ways) ===" << endl;
+        cout << fixed << setprecision(2);
+        cout << "References: " << stats.references << " (" << stats.invalid << " invalid)" << endl;
+        cout << "TLB Hits: " << stats.tlb_hits << " (" << stats.tlbHitRate() << "%), Misses: " << stats.tlbMisses() << endl;
+        cout << "Page Walks: " << stats.tlbMisses() << ", " << stats.readsPerWalk() << " table reads each ("
+             << pageWalkCost() << " ns)" << endl;
+        cout << "Page Faults: " << stats.page_faults << ", Evictions: " << stats.evictions
+             << ", Dirty Write-backs: " << stats.writebacks << endl;
+        cout << "Effective Access Time: " << effectiveAccessTime() << " ns (" << effectiveAccessTime(false)
+             << " ns without page faults; TLB " << config.tlb_ns << " ns, memory " << config.memory_ns << " ns)" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+
+        vector<int> pids;
+        for (const auto& space : spaces) {
+            pids.push_back(space.first);
+        }
+        sort(pids.begin(), pids.end());
+        cout << setw(6) << "PID" << setw(12) << "Resident" << setw(14) << "Table Nodes" << setw(12) << "Table KB" << endl;
+        cout << string(44, '-') << endl;
+        for (int pid : pids) {
+            const PageTable& table = *spaces.at(pid);
+            cout << setw(6) << pid << setw(12) << table.residentPages() << setw(14) << table.nodeCount()
+                 << setw(12) << table.bytes() / 1024 << endl;
+        }
+    }
+};
+
+// Synthetic reference stream: processes take turns in time slices and each
+// follows one pattern, by index: a sequential array sweep, a small hot
+// working set with occasional heap misses, or a few pages in each of many
+// regions spread across a large mapping (which grows sparse page tables).
+class AddressTraceGenerator {
+private:
+    static const uint64_t ARRAY_BASE = 0x400000;
+    static const uint64_t ARRAY_BYTES = 4 << 20;
+    static const uint64_t HEAP_BASE = 0x10000000;
+    static const uint64_t HOT_PAGES = 32;
+    static const uint64_t HEAP_PAGES = 16384;
+    static const uint64_t MAPPING_BASE = 0x7f0000000000;
+    static const uint64_t MAPPING_REGIONS = 64;    // 1 GiB apart
+    static const uint64_t REGION_PAGES = 8;
+
+    vector<uint32_t> pids;
+    vector<uint64_t> cursors;
+    mt19937_64 rng;
+    size_t slice_length;
+    size_t current = 0;
+    size_t left_in_slice;
+
+public:
+    AddressTraceGenerator(const vector<uint32_t>& process_ids, uint64_t seed = 42, size_t slice = 256)
+        : pids(process_ids), cursors(process_ids.size(), 0), rng(seed), slice_length(max<size_t>(1, slice)),
+          left_in_slice(slice_length) {}
+
+    MemoryReference next() {
+        if (left_in_slice == 0) {
+            current = (current + 1) % pids.size();
+            left_in_slice = slice_length;
+        }
+        left_in_slice--;
+        uint64_t bits = rng();
+        MemoryReference reference;
+        reference.pid = pids[current];
+        reference.flags = (bits & 3) == 0 ? MemoryReference::WRITE : 0;
+        uint64_t offset = (bits >> 2) & 0xFF8;
+        switch (current % 3) {
+        case 0:
+            reference.address = ARRAY_BASE + cursors[current];
+            cursors[current] = (cursors[current] + 8) % ARRAY_BYTES;
+            break;
+        case 1: {
+            uint64_t page = (bits >> 16) % 10 < 9 ? (bits >> 24) % HOT_PAGES : (bits >> 24) % HEAP_PAGES;
+            reference.address = HEAP_BASE + (page << PageTable::PAGE_BITS) + offset;
+            break;
+        }
+        default:
+            reference.address = MAPPING_BASE + ((bits >> 16) % MAPPING_REGIONS << 30) +
+                                (((bits >> 24) % REGION_PAGES) << PageTable::PAGE_BITS) + offset;
+            break;
+        }
+        return reference;
+    }
+
+    vector<MemoryReference> generate(size_t count) {
+        vector<MemoryReference> references(count);
+        for (auto& reference : references) {
+            reference = next();
+        }
+        return references;
+    }
+};
+
+// Address traces for --vm-replay. Binary traces are a TraceHeader ("OSVMTRC1")
+// followed by MemoryReferences and are read in place; text traces hold
+// "pid address [r|w]" per line with the address in decimal or 0x hex.
+class AddressTrace {
+private:
+    static constexpr char MAGIC[9] = "OSVMTRC1";
+
+    string path;
+    bool binary = false;
+    uint64_t record_count = 0;
+
+public:
+    static bool parseTextRecord(const char* line, MemoryReference& reference) {
+        char* end = nullptr;
+        unsigned long pid = strtoul(line, &end, 10);
+        if (end == line || pid == 0 || pid > UINT32_MAX) {
+            return false;
+        }
+        const char* address = end;
+        reference.address = strtoull(address, &end, 0);
+        if (end == address) {
+            return false;
+        }
+        while (*end == ' ' || *end == '\t') {
+            end++;
+        }
+        reference.pid = (uint32_t)pid;
+        reference.flags = (*end == 'w' || *end == 'W') ? MemoryReference::WRITE : 0;
+        return true;
+    }
+
+    bool open(const string& trace_path) {
+        path = trace_path;
+        record_count = 0;
+        FILE* in = fopen(path.c_str(), "rb");
+        if (!in) {
+            return false;
+        }
+        TraceHeader header;
+        size_t got = fread(&header, 1, sizeof(header), in);
+        fclose(in);
+        binary = got == sizeof(header) && memcmp(header.magic, MAGIC, sizeof(header.magic)) == 0;
+        if (binary) {
+            if (header.record_size != sizeof(MemoryReference)) {
+                return false;
+            }
+            record_count = header.record_count;
+        }
+        return true;
+    }
+
+    bool isBinary() const {
+        return binary;
+    }
+
+    uint64_t declaredRecords() const {
+        return record_count;
+    }
+
+    // visit(const MemoryReference&) is called once per well-formed record in file order
+    template <typename Visit>
+    bool forEach(Visit visit, uint64_t& malformed) {
+        malformed = 0;
+        if (binary) {
+            return forEachMappedRecord<MemoryReference>(path, record_count, visit);
+        }
+        FILE* in = fopen(path.c_str(), "r");
+        if (!in) {
+            return false;
+        }
+        char line[256];
+        MemoryReference reference;
+        while (fgets(line, sizeof(line), in)) {
+            const char* p = line;
+            while (*p == ' ' || *p == '\t') {
+                p++;
+            }
+            if (*p == '\0' || *p == '\n' || *p == '\r' || *p == '#') {
+                continue;
+            }
+            if (parseTextRecord(p, reference)) {
+                visit(reference);
+            } else {
+                malformed++;
+            }
+        }
+        fclose(in);
+        return true;
+    }
+
+    // Write count synthetic references for trace PIDs 1..processes
+    static bool generate(const string& output_path, uint64_t count, uint32_t processes) {
+        FILE* out = fopen(output_path.c_str(), "wb");
+        if (!out) {
+            return false;
+        }
+        TraceHeader header;
+        memcpy(header.magic, MAGIC, sizeof(header.magic));
+        header.record_size = sizeof(MemoryReference);
+        header.reserved = 0;
+        header.record_count = count;
+        bool ok = fwrite(&header, sizeof(header), 1, out) == 1;
+
+        vector<uint32_t> pids;
+        for (uint32_t pid = 1; pid <= max<uint32_t>(1, processes); pid++) {
+            pids.push_back(pid);
+        }
+        AddressTraceGenerator generator(pids);
+        const uint64_t BLOCK = 1 << 16;
+        for (uint64_t written = 0; ok && written < count; written += BLOCK) {
+            vector<MemoryReference> block = generator.generate((size_t)min(BLOCK, count - written));
+            ok = fwrite(block.data(), sizeof(MemoryReference), block.size(), out) == block.size();
+        }
+        return fclose(out) == 0 && ok;
+    }
+};
+
+constexpr char AddressTrace::MAGIC[9];
+
+// --- File Allocation Table ---
+enum class AllocationStrategy { FIRST_FIT, BEST_FIT, NEXT_FIT };
+
+struct Extent {
+    int start;
+    int length;
+};
+
+struct FragmentationStats {
+    int total_blocks = 0;
+    int used_blocks = 0;
+    int free_blocks = 0;
+    int free_holes = 0;
+    int largest_hole = 0;
+    int files = 0;
+    int extents = 0;
+
+    // Share of free space unusable for a request as large as all free space
+    double externalFragmentation() const {
+        return free_blocks ? (1.0 - (double)largest_hole / free_blocks) * 100 : 0;
+    }
+};
+
+// Extent-based allocator over a free-space bitmap (bit set = block in use).
+// Free and used runs are found a 64-bit word at a time, and each file stores
+// one (start, length) entry per contiguous run instead of one int per block.
+class FileAllocationTable {
+private:
+    static const int WORD_BITS = 64;
+
+    vector<unsigned long long> bitmap;
+    map<string, vector<Extent>> file_extents;
+    int total_blocks;
+    int free_blocks;
+    int next_fit_cursor;
+    AllocationStrategy strategy;
+
+    // First block at or after from whose bit equals used, or total_blocks
+    int findBlock(int from, bool used) const {
+        if (from >= total_blocks) {
+            return total_blocks;
+        }
+        size_t w = from / WORD_BITS;
+        unsigned long long word = (used ? bitmap[w] : ~bitmap[w]) & (~0ULL << (from % WORD_BITS));
+        while (true) {
+            if (word) {
+                return min(total_blocks, (int)(w * WORD_BITS) + countTrailingZeros(word));
+            }
+            if (++w >= bitmap.size()) {
+                return total_blocks;
+            }
+            word = used ? bitmap[w] : ~bitmap[w];
+        }
+    }
+
+    // Next free run at or after from; length 0 when there is none
+    Extent nextHole(int from) const {
+        int start = findBlock(from, false);
+        return {start, findBlock(start, true) - start};
+    }
+
+    void markRange(int start, int length, bool used) {
+        int end = start + length;
+        while (start < end) {
+            size_t w = start / WORD_BITS;
+            int bit = start % WORD_BITS;
+            int count = min(WORD_BITS - bit, end - start);
+            unsigned long long mask = (count == WORD_BITS) ? ~0ULL : (((1ULL << count) - 1) << bit);
+            if (used) {
+                bitmap[w] |= mask;
+            } else {
+                bitmap[w] &= ~mask;
+            }
+            start += count;
+        }
+        free_blocks += used ? -length : length;
+    }
+
+    // Pick a single hole of at least size blocks according to the strategy
+    Extent findHole(int size) const {
+        Extent best{total_blocks, 0};
+        if (strategy == AllocationStrategy::NEXT_FIT) {
+            for (int pass = 0; pass < 2; pass++) {
+                int pos = pass == 0 ? next_fit_cursor : 0;
+                int limit = pass == 0 ? total_blocks : next_fit_cursor;
+                for (Extent hole = nextHole(pos); hole.length > 0 && hole.start < limit; hole = nextHole(hole.start + hole.length)) {
+                    if (hole.length >= size) return hole;
+                }
+            }
+            return best;
+        }
+        for (Extent hole = nextHole(0); hole.length > 0; hole = nextHole(hole.start + hole.length)) {
+            if (hole.length < size) continue;
+            if (strategy == AllocationStrategy::FIRST_FIT) return hole;
+            if (best.length == 0 || hole.length < best.length) best = hole;
+        }
+        return best;
+    }
+
+    void appendExtent(vector<Extent>& extents, int start, int length) {
+        markRange(start, length, true);
+        if (!extents.empty() && extents.back().start + extents.back().length == start) {
+            extents.back().length += length;
+        } else {
+            extents.push_back({start, length});
+        }
+        next_fit_cursor = (start + length) % total_blocks;
+    }
+
+    // Allocate size blocks into extents: one contiguous hole when the strategy
+    // finds one, otherwise spill across holes in address order
+    bool allocateBlocks(vector<Extent>& extents, int size) {
+        if (size > free_blocks) {
+            return false;
+        }
+        if (size == 0) {
+            return true;
+        }
+        Extent hole = findHole(size);
+        if (hole.length >= size) {
+            appendExtent(extents, hole.start, size);
+            return true;
+        }
+        int needed = size;
+        for (Extent gap = nextHole(0); needed > 0 && gap.length > 0; gap = nextHole(gap.start + gap.length)) {
+            int take = min(needed, gap.length);
+            appendExtent(extents, gap.start, take);
+            needed -= take;
+        }
+        return true;
+    }
+
+    void freeExtents(const vector<Extent>& extents) {
+        for (const auto& extent : extents) {
+            markRange(extent.start, extent.length, false);
+        }
+    }
+
+    static int blockCount(const vector<Extent>& extents) {
+        int count = 0;
+        for (const auto& extent : extents) {
+            count += extent.length;
+        }
+        return count;
+    }
+
+    static void printExtents(const vector<Extent>& extents) {
+        for (const auto& extent : extents) {
+            cout << extent.start;
+            if (extent.length > 1) {
+                cout << "-" << extent.start + extent.length - 1;
+            }
+            cout << " ";
+        }
+    }
+
+public:
+    explicit FileAllocationTable(int blocks = 64)
+        : total_blocks(max(1, blocks)), free_blocks(0), next_fit_cursor(0), strategy(AllocationStrategy::FIRST_FIT) {
+        bitmap.assign((total_blocks + WORD_BITS - 1) / WORD_BITS, ~0ULL); // Bits past the end stay "used"
+        markRange(0, total_blocks, false);
+    }
+
+    void setStrategy(AllocationStrategy new_strategy) {
+        strategy = new_strategy;
+    }
+
+    static string strategyName(AllocationStrategy s) {
+        switch (s) {
+        case AllocationStrategy::BEST_FIT: return "Best Fit";
+        case AllocationStrategy::NEXT_FIT: return "Next Fit";
+        default: return "First Fit";
+        }
+    }
+
+    // Allocating an existing file replaces its contents. The new blocks are
+    // taken before the old ones are released, so a failed allocation leaves
+    // the file as it was.
+    bool allocateFile(const string& filename, int size, bool verbose = true) {
+        vector<Extent> extents;
+        if (!allocateBlocks(extents, max(0, size))) {
+            cout << "[FAT] Not enough free blocks for file: " << filename << " (" << size
+                 << " requested, " << free_blocks << " free)" << endl;
+            return false;
+        }
+        auto existing = file_extents.find(filename);
+        if (existing != file_extents.end()) {
+            freeExtents(existing->second);
+        }
+        if (verbose) {
+            cout << "[FAT] Allocated " << size << " blocks for file: " << filename << endl;
+            cout << "[FAT] Extents: ";
+            printExtents(extents);
+            cout << endl;
+        }
+        file_extents[filename] = move(extents);
+        return true;
+    }
+
+    // Grow a file, extending its last extent in place when the next blocks are free
+    bool extendFile(const string& filename, int blocks) {
+        auto it = file_extents.find(filename);
+        if (it == file_extents.end()) {
+            cout << "[FAT] File not found: " << filename << endl;
+            return false;
+        }
+        if (blocks <= 0) {
+            cout << "[FAT] Invalid extension size: " << blocks << endl;
+            return false;
+        }
+        if (blocks > free_blocks) {
+            cout << "[FAT] Not enough free blocks to extend " << filename << endl;
+            return false;
+        }
+        vector<Extent>& extents = it->second;
+        int needed = blocks;
+        if (!extents.empty()) {
+            int tail = extents.back().start + extents.back().length;
+            Extent hole = nextHole(tail);
+            if (hole.start == tail && hole.length > 0) {
+                int take = min(needed, hole.length);
+                appendExtent(extents, tail, take);
+                needed -= take;
+            }
+        }
+        allocateBlocks(extents, needed);
+        cout << "[FAT] Extended " << filename << " by " << blocks << " blocks" << endl;
+        return true;
+    }
+
+    // Shrink a file to new_size blocks, releasing the tail
+    bool truncateFile(const string& filename, int new_size) {
+        auto it = file_extents.find(filename);
+        if (it == file_extents.end()) {
+            cout << "[FAT] File not found: " << filename << endl;
+            return false;
+        }
+        vector<Extent>& extents = it->second;
+        int keep = max(0, new_size);
+        size_t kept_extents = 0;
+        for (; kept_extents < extents.size() && keep > 0; kept_extents++) {
+            Extent& extent = extents[kept_extents];
+            if (extent.length > keep) {
+                markRange(extent.start + keep, extent.length - keep, false);
+                extent.length = keep;
+            }
+            keep -= extent.length;
+        }
+        freeExtents(vector<Extent>(extents.begin() + kept_extents, extents.end()));
+        extents.resize(kept_extents);
+        cout << "[FAT] Truncated " << filename << " to " << max(0, new_size) << " blocks" << endl;
+        return true;
+    }
+
+    bool deleteFile(const string& filename) {
+        auto it = file_extents.find(filename);
+        if (it == file_extents.end()) {
+            cout << "[FAT] File not found: " << filename << endl;
+            return false;
+        }
+        freeExtents(it->second);
+        file_extents.erase(it);
+        cout << "[FAT] Deleted file: " << filename << endl;
+        return true;
+    }
+
+    // Disk block holding a file's logical block; -1 past the end or for an unknown file
+    int physicalBlock(const string& filename, int logical_block) const {
+        auto it = file_extents.find(filename);
+        if (it == file_extents.end() || logical_block < 0) {
+            return -1;
+        }
+        for (const auto& extent : it->second) {
+            if (logical_block < extent.length) {
+                return extent.start + logical_block;
+            }
+            logical_block -= extent.length;
+        }
+        return -1;
+    }
+
+    int fileBlocks(const string& filename) const {
+        auto it = file_extents.find(filename);
+        return it == file_extents.end() ? 0 : blockCount(it->second);
+    }
+
+    // Extents of a file in logical order; empty if the file does not exist
+    vector<Extent> getExtents(const string& filename) const {
+        auto it = file_extents.find(filename);
+        return it == file_extents.end() ? vector<Extent>() : it->second;
+    }
+
+    FragmentationStats getFragmentationStats() const {
+        FragmentationStats stats;
+        stats.total_blocks = total_blocks;
+        stats.free_blocks = free_blocks;
+        stats.used_blocks = total_blocks - free_blocks;
+        for (Extent hole = nextHole(0); hole.length > 0; hole = nextHole(hole.start + hole.length)) {
+            stats.free_holes++;
+            stats.largest_hole = max(stats.largest_hole, hole.length);
+        }
+        stats.files = (int)file_extents.size();
+        for (const auto& entry : file_extents) {
+            stats.extents += (int)entry.second.size();
+        }
+        return stats;
+    }
+    
+    void displayFAT() {
+        cout << "\n=== FILE ALLOCATION TABLE (" << strategyName(strategy) << ") ===" << endl;
+        cout << setw(20) << "Filename" << setw(8) << "Blocks" << setw(30) << "Extents" << endl;
+        cout << string(58, '-') << endl;
+        for (const auto& entry : file_extents) {
+            cout << setw(20) << entry.first << setw(8) << blockCount(entry.second) << "    ";
+            printExtents(entry.second);
+            cout << endl;
+        }
+
+        FragmentationStats stats = getFragmentationStats();
+        cout << "\nBlocks: " << stats.used_blocks << " used / " << stats.free_blocks << " free of "
+             << stats.total_blocks << endl;
+        cout << "Free Holes: " << stats.free_holes << " (largest " << stats.largest_hole << " blocks)" << endl;
+        cout << "Extents per File: " << fixed << setprecision(2)
+             << (stats.files ? (double)stats.extents / stats.files : 0.0) << endl;
+        cout << "External Fragmentation: " << stats.externalFragmentation() << "%" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+
+// --- Disk I/O Management with Scheduling ---
+struct DiskScheduleResult {
+    string algorithm;
+    vector<int> order;        // Requests in service order
+    vector<int> path;         // Every head position, including the start and any edge visits
+    long long total_seek = 0;
+    double average_seek = 0;
+
+    void moveTo(int& head, int target) {
+        total_seek += abs(target - head);
+        head = target;
+        path.push_back(target);
+    }
+
+    void service(int& head, int block) {
+        moveTo(head, block);
+        order.push_back(block);
+    }
+
+    void finish() {
+        average_seek = order.empty() ? 0 : (double)total_seek / order.size();
+    }
+};
+
+class DiskManager {
+private:
+    vector<int> disk_blocks;
+    FileAllocationTable fat;
+
+    static DiskScheduleResult startSchedule(const string& algorithm, int head, size_t request_count) {
+        DiskScheduleResult result;
+        result.algorithm = algorithm;
+        result.order.reserve(request_count);
+        result.path.reserve(request_count + 3);
+        result.path.push_back(head);
+        return result;
+    }
+
+    static void printSequence(const DiskScheduleResult& result) {
+        cout << "\nSeek Sequence: ";
+        for (size_t i = 0; i < result.path.size(); i++) {
+            cout << result.path[i] << (i + 1 < result.path.size() ? " -> " : "");
+        }
+        cout << "\n\nTotal Seek Time: " << result.total_seek << endl;
+        cout << "Average Seek Time: " << result.average_seek << endl;
+    }
+
+public:
+    // --- Pure scheduling algorithms: no output, suitable for large queues ---
+
+    static DiskScheduleResult scheduleFCFS(const vector<int>& requests, int head) {
+        DiskScheduleResult result = startSchedule("FCFS", head, requests.size());
+        for (int block : requests) {
+            result.service(head, block);
+        }
+        result.finish();
+        return result;
+    }
+
+    // Shortest Seek Time First. Requests are sorted once and threaded into a
+    // doubly linked list of still-pending neighbours. The head always sits
+    // between two pending neighbours, so the nearest request is one of them
+    // and removing it is O(1): O(n log n) overall for the sort instead of
+    // rescanning the queue for every request.
+    static DiskScheduleResult scheduleSSTF(vector<int> requests, int head) {
+        DiskScheduleResult result = startSchedule("SSTF", head, requests.size());
+        sort(requests.begin(), requests.end());
+        long long n = (long long)requests.size();
+        vector<long long> prev_pending(n), next_pending(n);
+        for (long long i = 0; i < n; i++) {
+            prev_pending[i] = i - 1;
+            next_pending[i] = i + 1; // n = none
+        }
+
+        long long above = lower_bound(requests.begin(), requests.end(), head) - requests.begin();
+        long long below = above - 1;
+        while (below >= 0 || above < n) {
+            long long nearest;
+            if (above >= n) {
+                nearest = below;
+            } else if (below < 0) {
+                nearest = above;
+            } else {
+                // Ties go to the lower cylinder
+                nearest = (head - requests[below] <= requests[above] - head) ? below : above;
+            }
+            result.service(head, requests[nearest]);
+
+            // Unlink the serviced request; its neighbours now bracket the head
+            long long p = prev_pending[nearest], q = next_pending[nearest];
+            if (p >= 0) next_pending[p] = q;
+            if (q < n) prev_pending[q] = p;
+            below = p;
+            above = q;
+        }
+        result.finish();
+        return result;
+    }
+
+    // Shared sweep for the elevator family. The head first moves toward higher
+    // blocks. go_to_edge: travel to the last block (SCAN/C-SCAN) instead of
+    // turning at the last request (LOOK/C-LOOK). circular: return to the low
+    // end and sweep upward again instead of reversing.
+    static DiskScheduleResult scheduleSweep(const string& algorithm, vector<int> requests, int head,
+                                            int disk_size, bool go_to_edge, bool circular) {
+        DiskScheduleResult result = startSchedule(algorithm, head, requests.size());
+        sort(requests.begin(), requests.end());
+        auto split = lower_bound(requests.begin(), requests.end(), head);
+
+        for (auto it = split; it != requests.end(); ++it) {
+            result.service(head, *it);
+        }
+        if (split == requests.begin()) {
+            result.finish(); // Nothing below the start: no need to turn around
+            return result;
+        }
+        if (go_to_edge && head != disk_size - 1) {
+            result.moveTo(head, disk_size - 1);
+        }
+        if (circular) {
+            if (go_to_edge) {
+                result.moveTo(head, 0); // Return sweep counts as head movement
+            }
+            for (auto it = requests.begin(); it != split; ++it) {
+                result.service(head, *it);
+            }
+        } else {
+            for (auto it = split; it != requests.begin();) {
+                result.service(head, *--it);
+            }
+        }
+        result.finish();
+        return result;
+    }
+
+    static DiskScheduleResult scheduleSCAN(const vector<int>& requests, int head, int disk_size) {
+        return scheduleSweep("SCAN", requests, head, disk_size, true, false);
+    }
+
+    static DiskScheduleResult scheduleCSCAN(const vector<int>& requests, int head, int disk_size) {
+        return scheduleSweep("C-SCAN", requests, head, disk_size, true, true);
+    }
+
+    static DiskScheduleResult scheduleLOOK(const vector<int>& requests, int head) {
+        return scheduleSweep("LOOK", requests, head, 0, false, false);
+    }
+
+    static DiskScheduleResult scheduleCLOOK(const vector<int>& requests, int head) {
+        return scheduleSweep("C-LOOK", requests, head, 0, false, true);
+    }
+
+    // Algorithms in menu order (FCFS has its own menu entry)
+    static const int ALGORITHM_COUNT = 5;
+
+    static DiskScheduleResult schedule(int index, const vector<int>& requests, int head, int disk_size) {
+        switch (index) {
+        case 0: return scheduleSCAN(requests, head, disk_size);
+        case 1: return scheduleSSTF(requests, head);
+        case 2: return scheduleCSCAN(requests, head, disk_size);
+        case 3: return scheduleLOOK(requests, head);
+        default: return scheduleCLOOK(requests, head);
+        }
+    }
+
+    // --- Simulations with console output ---
+
+    void simulateDiskAccessFCFS(const vector<int>& block_requests) {
+        cout << "\n=== DISK SCHEDULING: FCFS (First Come First Serve) ===" << endl;
+        cout << "Request Sequence: ";
+        for (int block : block_requests) {
+            cout << block << " ";
+        }
+        cout << endl;
+
+        DiskScheduleResult result = scheduleFCFS(block_requests, 0);
+        
+        cout << "\nSeek Sequence:\n";
+        cout << setw(10) << "From" << setw(10) << "To" << setw(15) << "Seek Time" << endl;
+        cout << string(35, '-') << endl;
+        
+        for (size_t i = 1; i < result.path.size(); i++) {
+            cout << setw(10) << result.path[i - 1] << setw(10) << result.path[i]
+                 << setw(15) << abs(result.path[i] - result.path[i - 1]) << endl;
+        }
+        disk_blocks.insert(disk_blocks.end(), result.order.begin(), result.order.end());
+        
+        cout << "\nTotal Seek Time: " << result.total_seek << endl;
+        cout << "Average Seek Time: " << result.average_seek << endl;
+    }
+    
+    void simulateDiskAccessSCAN(const vector<int>& block_requests, int initial_head, int disk_size) {
+        cout << "\n=== DISK SCHEDULING: SCAN (Elevator Algorithm) ===" << endl;
+        cout << "Initial Head Position: " << initial_head << endl;
+        cout << "Disk Size: " << disk_size << endl;
+        printSequence(scheduleSCAN(block_requests, initial_head, disk_size));
+    }
+
+    void simulateDiskAccess(int algorithm, const vector<int>& block_requests, int initial_head, int disk_size) {
+        DiskScheduleResult result = schedule(algorithm, block_requests, initial_head, disk_size);
+        cout << "\n=== DISK SCHEDULING: " << result.algorithm << " ===" << endl;
+        cout << "Initial Head Position: " << initial_head << endl;
+        cout << "Disk Size: " << disk_size << endl;
+        printSequence(result);
+    }
+
+    static void compareAlgorithms(const vector<int>& block_requests, int initial_head, int disk_size) {
+        cout << "\n=== DISK SCHEDULING COMPARISON (Head = " << initial_head << ", "
+             << block_requests.size() << " requests) ===" << endl;
+        cout << setw(10) << "Algorithm" << setw(15) << "Total Seek" << setw(15) << "Average Seek" << endl;
+        cout << string(40, '-') << endl;
+        vector<DiskScheduleResult> results = {scheduleFCFS(block_requests, initial_head)};
+        for (int i = 0; i < ALGORITHM_COUNT; i++) {
+            results.push_back(schedule(i, block_requests, initial_head, disk_size));
+        }
+        for (const auto& result : results) {
+            cout << setw(10) << result.algorithm << setw(15) << result.total_seek
+                 << setw(15) << fixed << setprecision(2) << result.average_seek << endl;
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
     
-    ProcessControlBlock(int p, string tid) 
-        : pid(p), transaction_id(tid), status("NEW"), 
-          arrival_time(0), burst_time(1), waiting_time(0), turnaround_time(0) {}
+    FileAllocationTable* getFAT() {
+        return &fat;
+    }
+};
+
+// --- Buffer Cache ---
+// Block cache between FAT-level file I/O and the disk. Blocks are cached by
+// disk address with LRU replacement. Sequential reads of a file grow a
+// read-ahead window, so the blocks that follow arrive in the same physical
+// request. Writes only dirty the cached block; dirty blocks go to disk
+// together in LOOK order once enough have built up or one is evicted, and
+// adjacent blocks in a batch merge into one request. Every block request is
+// also charged to an uncached disk (one FCFS request per block) so the two
+// can be compared.
+struct BufferCacheConfig {
+    size_t capacity = 64;          // Blocks
+    int read_ahead_max = 32;       // Largest read-ahead window; 0 disables read-ahead
+    size_t write_back_batch = 16;  // Dirty blocks that trigger a write-back
+};
+
+struct BufferCacheStats {
+    uint64_t reads = 0;
+    uint64_t writes = 0;
+    uint64_t hits = 0;
+    uint64_t prefetched = 0;       // Blocks brought in by read-ahead
+    uint64_t prefetch_hits = 0;    // Prefetched blocks requested later
+    uint64_t evictions = 0;
+    uint64_t write_batches = 0;
+    uint64_t written_back = 0;
+    uint64_t disk_requests = 0;    // Physical requests after merging adjacent blocks
+    uint64_t disk_blocks = 0;
+    long long seek_distance = 0;
+    uint64_t uncached_requests = 0;
+    long long uncached_seek = 0;
+
+    uint64_t requests() const {
+        return reads + writes;
+    }
+
+    double hitRate() const {
+        return requests() ? (double)hits / requests() * 100 : 0;
+    }
+
+    double requestsRemoved() const {
+        return uncached_requests ? (1 - (double)disk_requests / uncached_requests) * 100 : 0;
+    }
+
+    double seekRemoved() const {
+        return uncached_seek ? (1 - (double)seek_distance / uncached_seek) * 100 : 0;
+    }
+};
+
+struct BlockRequest {
+    int file;                      // Index into the workload's file names
+    int block;                     // Logical block within the file
+    bool write;
+};
+
+class BufferCache {
+private:
+    struct CachedBlock {
+        int disk_block;
+        bool dirty;
+        bool prefetched;           // Read ahead and not requested yet
+    };
+
+    struct ReadAhead {
+        int next = -1;             // Logical block that would continue the sequence
+        int window = 0;
+        int trigger = 0;           // Reading this block starts the next read-ahead
+        int end = 0;               // One past the last block read ahead
+    };
+
+    FileAllocationTable* fat;
+    BufferCacheConfig config;
+    list<CachedBlock> lru;         // Most recently used first
+    unordered_map<int, list<CachedBlock>::iterator> blocks;
+    unordered_map<string, ReadAhead> read_ahead;
+    size_t dirty_count = 0;
+    int head;
+    int uncached_head;
+    BufferCacheStats stats;
+
+    // One batch of physical I/O, serviced in LOOK order from the current head
+    void diskIO(const vector<int>& disk_blocks) {
+        if (disk_blocks.empty()) {
+            return;
+        }
+        DiskScheduleResult result = DiskManager::scheduleLOOK(disk_blocks, head);
+        stats.seek_distance += result.total_seek;
+        stats.disk_blocks += result.order.size();
+        for (size_t i = 0; i < result.order.size(); i++) {
+            if (i == 0 || abs(result.order[i] - result.order[i - 1]) != 1) {
+                stats.disk_requests++;
+            }
+        }
+        head = result.order.back();
+    }
+
+    void writeBack() {
+        vector<int> dirty;
+        for (CachedBlock& block : lru) {
+            if (block.dirty) {
+                dirty.push_back(block.disk_block);
+                block.dirty = false;
+            }
+        }
+        dirty_count = 0;
+        if (!dirty.empty()) {
+            stats.write_batches++;
+            stats.written_back += dirty.size();
+            diskIO(dirty);
+        }
+    }
+
+    // Evicting a dirty block writes back every dirty block in one batch
+    void makeRoom() {
+        while (lru.size() >= config.capacity) {
+            if (lru.back().dirty) {
+                writeBack();
+            }
+            blocks.erase(lru.back().disk_block);
+            lru.pop_back();
+            stats.evictions++;
+        }
+    }
+
+    CachedBlock* lookup(int disk_block) {
+        auto it = blocks.find(disk_block);
+        if (it == blocks.end()) {
+            return nullptr;
+        }
+        lru.splice(lru.begin(), lru, it->second);
+        return &*it->second;
+    }
+
+    void insert(int disk_block, bool dirty, bool prefetched) {
+        makeRoom();
+        lru.push_front({disk_block, dirty, prefetched});
+        blocks[disk_block] = lru.begin();
+        if (dirty) {
+            dirty_count++;
+        }
+    }
+
+    void chargeUncached(int disk_block) {
+        stats.uncached_requests++;
+        stats.uncached_seek += abs(disk_block - uncached_head);
+        uncached_head = disk_block;
+    }
+
+    // Blocks to prefetch after a read of logical_block. The window starts at 4
+    // and doubles on every sequential read; once the reader reaches the first
+    // block of the last read-ahead, the next window is fetched past its end.
+    void planReadAhead(const string& filename, int logical_block, vector<int>& prefetch) {
+        int max_window = min(config.read_ahead_max, (int)(config.capacity / 8));
+        ReadAhead& state = read_ahead[filename];
+        bool sequential = logical_block == state.next;
+        state.next = logical_block + 1;
+        if (!sequential || max_window <= 0) {
+            state.window = state.trigger = state.end = 0;
+            return;
+        }
+        state.window = min(max(state.window * 2, 4), max_window);
+        if (logical_block < state.trigger) {
+            return;
+        }
+        int from = max(logical_block + 1, state.end);
+        int to = min(from + state.window, fat->fileBlocks(filename));
+        for (int block = from; block < to; block++) {
+            int disk_block = fat->physicalBlock(filename, block);
+            if (!blocks.count(disk_block)) {
+                prefetch.push_back(disk_block);
+            }
+        }
+        state.trigger = from;
+        state.end = max(from, to);
+    }
+
+public:
+    explicit BufferCache(FileAllocationTable* table, const BufferCacheConfig& cache_config = BufferCacheConfig(),
+                         int initial_head = 0)
+        : fat(table), config(cache_config), head(initial_head), uncached_head(initial_head) {
+        config.capacity = max<size_t>(1, config.capacity);
+        config.write_back_batch = max<size_t>(1, config.write_back_batch);
+    }
+
+    // Returns false past the end of the file
+    bool read(const string& filename, int logical_block) {
+        int disk_block = fat->physicalBlock(filename, logical_block);
+        if (disk_block < 0) {
+            return false;
+        }
+        stats.reads++;
+        chargeUncached(disk_block);
+        CachedBlock* cached = lookup(disk_block);
+        if (cached) {
+            stats.hits++;
+            if (cached->prefetched) {
+                cached->prefetched = false;
+                stats.prefetch_hits++;
+            }
+        }
+
+        vector<int> prefetch;
+        if (config.read_ahead_max > 0) {
+            planReadAhead(filename, logical_block, prefetch);
+        }
+        for (int block : prefetch) {
+            insert(block, false, true);
+        }
+        stats.prefetched += prefetch.size();
+        if (!cached) {
+            insert(disk_block, false, false);
+            prefetch.push_back(disk_block);
+        }
+        diskIO(prefetch);
+        return true;
+    }
+
+    // Whole-block write: a miss allocates a buffer without reading the disk
+    bool write(const string& filename, int logical_block) {
+        int disk_block = fat->physicalBlock(filename, logical_block);
+        if (disk_block < 0) {
+            return false;
+        }
+        stats.writes++;
+        chargeUncached(disk_block);
+        CachedBlock* cached = lookup(disk_block);
+        if (cached) {
+            stats.hits++;
+            cached->prefetched = false;
+            if (!cached->dirty) {
+                cached->dirty = true;
+                dirty_count++;
+            }
+        } else {
+            insert(disk_block, true, false);
+        }
+        if (dirty_count >= config.write_back_batch) {
+            writeBack();
+        }
+        return true;
+    }
+
+    // Write back every dirty block
+    void sync() {
+        writeBack();
+    }
+
+    BufferCacheStats replay(const vector<string>& files, const vector<BlockRequest>& requests) {
+        for (const BlockRequest& request : requests) {
+            if (request.write) {
+                write(files[request.file], request.block);
+            } else {
+                read(files[request.file], request.block);
+            }
+        }
+        sync();
+        return stats;
+    }
+
+    const BufferCacheStats& getStats() const {
+        return stats;
+    }
+
+    // Log-heavy banking workload: appends to transaction_log.txt and
+    // audit_trail.log, readers replaying both logs in runs of blocks, lookups that
+    // mostly hit the start of account_data.dat and occasional index updates.
+    // Allocates the files in fat and returns their names.
+    static vector<string> logWorkload(FileAllocationTable& fat, size_t count, vector<BlockRequest>& requests,
+                                      bool verbose = false, uint32_t seed = 42) {
+        vector<string> files = {"transaction_log.txt", "audit_trail.log", "account_data.dat", "customer_index.idx"};
+        const int sizes[] = {512, 256, 128, 32};
+        const int READ_RUN = 8;
+        for (size_t i = 0; i < files.size(); i++) {
+            fat.allocateFile(files[i], sizes[i], verbose);
+        }
+        mt19937 rng(seed);
+        int log_tail[2] = {0, 0};
+        int log_reader[2] = {0, 0};
+        requests.clear();
+        requests.reserve(count);
+        while (requests.size() < count) {
+            int roll = (int)(rng() % 100);
+            if (roll < 55) {
+                int log = roll < 40 ? 0 : 1;
+                requests.push_back({log, log_tail[log]++ % sizes[log], true});
+            } else if (roll < 70) {
+                // Readers fetch the log a run of blocks at a time
+                int log = roll < 65 ? 0 : 1;
+                for (int run = 0; run < READ_RUN && requests.size() < count; run++) {
+                    requests.push_back({log, log_reader[log]++ % sizes[log], false});
+                }
+            } else if (roll < 95) {
+                int block = rng() % 10 < 8 ? (int)(rng() % 16) : (int)(rng() % sizes[2]);
+                requests.push_back({2, block, false});
+            } else {
+                requests.push_back({3, (int)(rng() % sizes[3]), true});
+            }
+        }
+        return files;
+    }
+
+    // Physical I/O of the log workload for several cache sizes, with and
+    // without read-ahead
+    static void compareConfigurations(const vector<size_t>& capacities, size_t request_count) {
+        cout << "\n=== BUFFER CACHE COMPARISON (" << request_count << " block requests, log workload) ===" << endl;
+        cout << setw(8) << "Cache" << setw(12) << "Read-Ahead" << setw(10) << "Hit %" << setw(12) << "Requests"
+             << setw(12) << "Seek" << setw(12) << "Req Cut %" << setw(12) << "Seek Cut %" << endl;
+        cout << string(78, '-') << endl;
+        bool baseline_printed = false;
+        cout << fixed << setprecision(1);
+        for (size_t capacity : capacities) {
+            for (bool read_ahead : {false, true}) {
+                FileAllocationTable table(1024);
+                vector<BlockRequest> requests;
+                vector<string> files = logWorkload(table, request_count, requests);
+                BufferCacheConfig config;
+                config.capacity = capacity;
+                config.read_ahead_max = read_ahead ? config.read_ahead_max : 0;
+                BufferCache cache(&table, config);
+                BufferCacheStats stats = cache.replay(files, requests);
+                if (!baseline_printed) {
+                    cout << setw(8) << "none" << setw(12) << "-" << setw(10) << 0.0 << setw(12) << stats.uncached_requests
+                         << setw(12) << stats.uncached_seek << setw(12) << 0.0 << setw(12) << 0.0 << endl;
+                    baseline_printed = true;
+                }
+                cout << setw(8) << capacity << setw(12) << (read_ahead ? "on" : "off") << setw(10) << stats.hitRate()
+                     << setw(12) << stats.disk_requests << setw(12) << stats.seek_distance
+                     << setw(12) << stats.requestsRemoved() << setw(12) << stats.seekRemoved() << endl;
+            }
+        }
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+
+    void displayStats() const {
+        cout << "\n=== BUFFER CACHE (" << config.capacity << " blocks, read-ahead up to "
+             << min(config.read_ahead_max, (int)(config.capacity / 8)) << ", write-back every "
+             << config.write_back_batch << " dirty blocks) ===" << endl;
+        cout << fixed << setprecision(2);
+        cout << "Block Requests: " << stats.requests() << " (" << stats.reads << " reads, " << stats.writes << " writes)" << endl;
+        cout << "Cache Hits: " << stats.hits << " (" << stats.hitRate() << "%), Evictions: " << stats.evictions << endl;
+        cout << "Read-Ahead: " << stats.prefetched << " blocks prefetched, " << stats.prefetch_hits << " used" << endl;
+        cout << "Write-Back: " << stats.written_back << " blocks in " << stats.write_batches << " LOOK batches" << endl;
+        cout << setw(20) << "" << setw(12) << "Cached" << setw(12) << "Uncached" << endl;
+        cout << setw(20) << left << "Disk Requests" << right << setw(12) << stats.disk_requests
+             << setw(12) << stats.uncached_requests << endl;
+        cout << setw(20) << left << "Blocks Transferred" << right << setw(12) << stats.disk_blocks
+             << setw(12) << stats.uncached_requests << endl;
+        cout << setw(20) << left << "Seek Distance" << right << setw(12) << stats.seek_distance
+             << setw(12) << stats.uncached_seek << endl;
+        cout << "Physical I/O Removed: " << stats.requestsRemoved() << "% of requests, "
+             << stats.seekRemoved() << "% of seek distance" << endl;
+        cout.unsetf(ios::fixed);
+        cout << setprecision(6);
+    }
+};
+
+// --- Trace Analytics ---
+// Offline characterization of large reference traces, for sizing frames and
+// choosing a disk policy. Traces are stored by column: a ColumnarHeader, a
+// directory of ColumnInfo entries and one 64-byte aligned uint32 array per
+// column, so a multi-gigabyte file is mapped and scanned in place.
+//   page   dense page ids, all below the column's cardinality
+//   block  disk block numbers in request order
+struct ColumnarHeader {
+    char magic[8];                   // "OSCOLTR1"
+    uint64_t rows;
+    uint32_t column_count;
+    uint32_t reserved;
+};
+
+struct ColumnInfo {
+    char name[16];                   // NUL-padded
+    uint64_t offset;                 // From the start of the file
+    uint64_t cardinality;            // Every value in the column is below this
+};
+
+static_assert(sizeof(ColumnarHeader) == 24 && sizeof(ColumnInfo) == 32, "columnar layout is part of the file format");
+
+class ColumnarTrace {
+private:
+    static constexpr char MAGIC[9] = "OSCOLTR1";
+    static const size_t ALIGNMENT = 64;
+    // Analyses keep tables indexed by value: about 16 bytes per value shared,
+    // plus 4 bytes per value per worker (see TraceAnalyzer::WORKER_MEMORY)
+    static const uint64_t MAX_CARDINALITY = 1ULL << 26;
+
+    char* data = nullptr;
+    size_t data_size = 0;
+#ifdef _WIN32
+    vector<char> buffer;
+#endif
+    uint64_t row_count = 0;
+    vector<ColumnInfo> columns;
+
+    static uint64_t aligned(uint64_t offset) {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Analyses index tables by value, so a value at or above the recorded
+    // cardinality would write out of bounds. Four running maxima keep the
+    // scan at memory speed.
+    static bool valuesBelow(const uint32_t* values, uint64_t count, uint64_t cardinality) {
+        uint32_t high[4] = {0, 0, 0, 0};
+        uint64_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            for (int lane = 0; lane < 4; lane++) {
+                high[lane] = max(high[lane], values[i + lane]);
+            }
+        }
+        for (; i < count; i++) {
+            high[0] = max(high[0], values[i]);
+        }
+        uint32_t highest = max(max(high[0], high[1]), max(high[2], high[3]));
+        return count == 0 || highest < cardinality;
+    }
+
+public:
+    // Streams columns one after another; every column must get the same
+    // number of values. The header is rewritten by close().
+    class Writer {
+    private:
+        FILE* out = nullptr;
+        vector<ColumnInfo> columns;
+        size_t column_count = 0;
+        uint64_t position = 0;
+        uint64_t column_rows = 0;
+        uint64_t rows = 0;
+        bool ok = true;
+
+    public:
+        ~Writer() {
+            if (out) {
+                fclose(out);
+            }
+        }
+
+        bool open(const string& path, size_t count) {
+            out = fopen(path.c_str(), "wb");
+            column_count = count;
+            position = sizeof(ColumnarHeader) + count * sizeof(ColumnInfo);
+            vector<char> placeholder(position, 0);
+            ok = out && fwrite(placeholder.data(), 1, placeholder.size(), out) == placeholder.size();
+            return ok;
+        }
+
+        void beginColumn(const string& name) {
+            if (!columns.empty()) {
+                rows = columns.size() == 1 ? column_rows : rows;
+                ok = ok && column_rows == rows;
+            }
+            static const char padding[ALIGNMENT] = {};
+            uint64_t start = aligned(position);
+            ok = ok && fwrite(padding, 1, (size_t)(start - position), out) == start - position;
+            position = start;
+            ColumnInfo info;
+            memset(&info, 0, sizeof(info));
+            strncpy(info.name, name.c_str(), sizeof(info.name) - 1);
+            info.offset = start;
+            columns.push_back(info);
+            column_rows = 0;
+        }
+
+        void append(const uint32_t* values, size_t count) {
+            ColumnInfo& info = columns.back();
+            for (size_t i = 0; i < count; i++) {
+                info.cardinality = max<uint64_t>(info.cardinality, (uint64_t)values[i] + 1);
+            }
+            ok = ok && fwrite(values, sizeof(uint32_t), count, out) == count;
+            position += count * sizeof(uint32_t);
+            column_rows += count;
+        }
+
+        bool close() {
+            if (!out) {
+                return false;
+            }
+            rows = columns.size() <= 1 ? column_rows : rows;
+            ok = ok && columns.size() == column_count && column_rows == rows;
+            for (const ColumnInfo& info : columns) {
+                ok = ok && info.cardinality <= MAX_CARDINALITY; // open() would refuse the file
+            }
+            ColumnarHeader header;
+            memcpy(header.magic, MAGIC, sizeof(header.magic));
+            header.rows = rows;
+            header.column_count = (uint32_t)columns.size();
+            header.reserved = 0;
+            ok = ok && fseek(out, 0, SEEK_SET) == 0 && fwrite(&header, sizeof(header), 1, out) == 1
+                 && fwrite(columns.data(), sizeof(ColumnInfo), columns.size(), out) == columns.size();
+            ok = fclose(out) == 0 && ok;
+            out = nullptr;
+            return ok;
+        }
+    };
+
+    ColumnarTrace() = default;
+    ColumnarTrace(const ColumnarTrace&) = delete;
+    ColumnarTrace& operator=(const ColumnarTrace&) = delete;
+
+    ~ColumnarTrace() {
+        close();
+    }
+
+    bool open(const string& path) {
+        close();
+#ifndef _WIN32
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ColumnarHeader)) {
+            ::close(fd);
+            return false;
+        }
+        size_t size = (size_t)info.st_size;
+        void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
+        }
+        madvise(mapping, size, MADV_SEQUENTIAL);
+        data = static_cast<char*>(mapping);
+        data_size = size;
+#else
+        ifstream in(path, ios::binary | ios::ate);
+        if (!in) {
+            return false;
+        }
+        buffer.resize((size_t)in.tellg());
+        in.seekg(0);
+        in.read(buffer.data(), buffer.size());
+        data = buffer.data();
+        data_size = buffer.size();
+#endif
+        const ColumnarHeader* header = reinterpret_cast<const ColumnarHeader*>(data);
+        if (data_size < sizeof(ColumnarHeader) || memcmp(header->magic, MAGIC, sizeof(header->magic)) != 0
+            || (data_size - sizeof(ColumnarHeader)) / sizeof(ColumnInfo) < header->column_count) {
+            close();
+            return false;
+        }
+        row_count = header->rows;
+        const ColumnInfo* directory = reinterpret_cast<const ColumnInfo*>(data + sizeof(ColumnarHeader));
+        for (uint32_t i = 0; i < header->column_count; i++) {
+            ColumnInfo column = directory[i];
+            column.name[sizeof(column.name) - 1] = '\0';
+            if (column.offset % ALIGNMENT != 0 || column.offset > data_size
+                || (data_size - column.offset) / sizeof(uint32_t) < row_count
+                || column.cardinality > MAX_CARDINALITY
+                || !valuesBelow(reinterpret_cast<const uint32_t*>(data + column.offset), row_count, column.cardinality)) {
+                close();
+                return false;
+            }
+            columns.push_back(column);
+        }
+        return true;
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (data) {
+            munmap(data, data_size);
+        }
+#else
+        buffer.clear();
+        buffer.shrink_to_fit();
+#endif
+        data = nullptr;
+        data_size = 0;
+        row_count = 0;
+        columns.clear();
+    }
+
+    uint64_t rows() const {
+        return row_count;
+    }
+
+    // nullptr when the trace has no such column
+    const uint32_t* column(const string& name, uint64_t& cardinality) const {
+        for (const ColumnInfo& info : columns) {
+            if (name == info.name) {
+                cardinality = info.cardinality;
+                return reinterpret_cast<const uint32_t*>(data + info.offset);
+            }
+        }
+        cardinality = 0;
+        return nullptr;
+    }
+
+    // Synthetic page and block columns. Pages move through phases with
+    // working sets of 256-4096 pages (90% of references) out of 1M pages;
+    // disk requests mix sequential runs with random blocks on a 1M-block disk.
+    static bool generate(const string& path, uint64_t rows, uint32_t seed = 42) {
+        const uint32_t PAGES = 1 << 20;
+        const uint32_t BLOCKS = 1 << 20;
+        const uint64_t PHASE = 1 << 20;
+        const size_t BLOCK = 1 << 16;
+        Writer writer;
+        if (!writer.open(path, 2)) {
+            return false;
+        }
+        vector<uint32_t> values;
+        mt19937_64 rng(seed);
+        writer.beginColumn("page");
+        uint32_t working_base = 0, working_size = 256;
+        for (uint64_t row = 0; row < rows; row += values.size()) {
+            values.resize((size_t)min<uint64_t>(BLOCK, rows - row));
+            for (size_t i = 0; i < values.size(); i++) {
+                if ((row + i) % PHASE == 0) {
+                    working_size = 256u << ((row + i) / PHASE % 5);
+                    working_base = (uint32_t)(rng() % (PAGES - working_size));
+                }
+                uint64_t bits = rng();
+                values[i] = (bits & 0xFF) < 230 ? working_base + (uint32_t)((bits >> 8) % working_size)
+                                                : (uint32_t)((bits >> 8) % PAGES);
+            }
+            writer.append(values.data(), values.size());
+        }
+        writer.beginColumn("block");
+        uint32_t cursor = 0, run_left = 0;
+        for (uint64_t row = 0; row < rows; row += values.size()) {
+            values.resize((size_t)min<uint64_t>(BLOCK, rows - row));
+            for (auto& block : values) {
+                if (run_left > 0) {
+                    run_left--;
+                    cursor = (cursor + 1) % BLOCKS;
+                } else {
+                    uint64_t bits = rng();
+                    cursor = (uint32_t)((bits >> 8) % BLOCKS);
+                    run_left = (bits & 1) ? 8 + (uint32_t)((bits >> 40) % 120) : 0;
+                }
+                block = cursor;
+            }
+            writer.append(values.data(), values.size());
+        }
+        return writer.close();
+    }
+
+    // Page column from an address trace: each distinct (pid, virtual page)
+    // gets the next dense id
+    static bool fromAddressTrace(const string& input_path, const string& output_path, uint64_t& rows,
+                                 uint64_t& distinct, uint64_t& malformed) {
+        AddressTrace input;
+        Writer writer;
+        if (!input.open(input_path) || !writer.open(output_path, 1)) {
+            return false;
+        }
+        writer.beginColumn("page");
+        unordered_map<uint64_t, uint32_t> ids;
+        vector<uint32_t> block;
+        block.reserve(1 << 16);
+        rows = 0;
+        bool ok = input.forEach([&](const MemoryReference& reference) {
+            uint64_t vpn = (reference.address >> PageTable::PAGE_BITS) & ((uint64_t(1) << 36) - 1);
+            auto inserted = ids.emplace(((uint64_t)reference.pid << 36) | vpn, (uint32_t)ids.size());
+            block.push_back(inserted.first->second);
+            if (block.size() == block.capacity()) {
+                writer.append(block.data(), block.size());
+                block.clear();
+            }
+            rows++;
+        }, malformed);
+        writer.append(block.data(), block.size());
+        distinct = ids.size();
+        return writer.close() && ok;
+    }
+};
+
+constexpr char ColumnarTrace::MAGIC[9];
+
+struct ReuseProfile {
+    uint64_t references = 0;
+    uint64_t cold = 0;               // First reference to a page
+    // Distinct other pages referenced between two uses of a page (LRU stack distance - 1)
+    vector<uint64_t> buckets = vector<uint64_t>(LogLinearBuckets::COUNT);
+
+    // LRU faults with the given number of frames: a reference hits when fewer
+    // than frames other pages were used since its page's previous use. Exact
+    // when frames is a bucket boundary, which every power of two is.
+    uint64_t lruFaults(uint64_t frames) const {
+        uint64_t faults = cold;
+        for (int i = LogLinearBuckets::indexOf(frames); i < LogLinearBuckets::COUNT; i++) {
+            faults += buckets[i];
+        }
+        return faults;
+    }
+};
+
+struct WorkingSetProfile {
+    uint64_t window = 0;
+    vector<uint32_t> sizes;          // Distinct pages in each consecutive window
+};
+
+struct SeekProfile {
+    uint64_t requests = 0;           // Head movements (requests after the first)
+    uint64_t total = 0;
+    uint32_t longest = 0;
+    vector<uint64_t> buckets = vector<uint64_t>(LogLinearBuckets::COUNT);
+
+    void merge(const SeekProfile& other) {
+        requests += other.requests;
+        total += other.total;
+        longest = max(longest, other.longest);
+        for (int i = 0; i < LogLinearBuckets::COUNT; i++) {
+            buckets[i] += other.buckets[i];
+        }
+    }
+};
+
+struct PolicySeek {
+    string algorithm;
+    long long total_seek = 0;
 };
 
-// --- Process Table ---
-class ProcessTable {
-private:
-    vector<ProcessControlBlock> processes;
-    mutex table_mutex;
-    int next_pid;
-    
+// Every analysis cuts the trace into chunks that worker threads take in
+// turn; per-chunk results are merged in trace order, so the output does not
+// depend on the thread count.
+class TraceAnalyzer {
+public:
+    static const size_t CHUNK_ROWS = 1 << 20;
+    static const uint64_t WORKER_MEMORY = 1ULL << 31; // Bytes for all per-worker page tables
+
+private:
+    // work(chunk, worker) for every chunk; each worker index is used by one thread
+    template <typename Work>
+    static void forEachChunk(size_t chunk_count, unsigned workers, Work work) {
+        atomic<size_t> next{0};
+        auto run = [&](unsigned worker) {
+            for (size_t chunk; (chunk = next.fetch_add(1)) < chunk_count;) {
+                work(chunk, worker);
+            }
+        };
+        vector<thread> threads;
+        for (unsigned worker = 1; worker < workers; worker++) {
+            threads.emplace_back(run, worker);
+        }
+        run(0);
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    // Per-page tables are per worker, so large cardinalities get fewer workers
+    // to keep those tables within WORKER_MEMORY in total
+    static unsigned workerCount(unsigned threads, size_t chunk_count, uint64_t cardinality) {
+        uint64_t table_bytes = max<uint64_t>(1, cardinality * sizeof(uint32_t));
+        return workerCount((unsigned)max<uint64_t>(1, min<uint64_t>(threads, WORKER_MEMORY / table_bytes)), chunk_count);
+    }
+
+    static unsigned workerCount(unsigned threads, size_t chunk_count) {
+        return (unsigned)max<size_t>(1, min<size_t>(threads, chunk_count));
+    }
+
+    // Fenwick tree of marks over positions
+    struct Fenwick {
+        vector<uint32_t> tree;
+
+        void reset(size_t size) {
+            tree.assign(size + 1, 0);
+        }
+        void mark(size_t position) {
+            for (size_t i = position + 1; i < tree.size(); i += i & (0 - i)) {
+                tree[i]++;
+            }
+        }
+        // Marks in [low, high)
+        uint64_t count(size_t low, size_t high) const {
+            uint64_t sum = 0;
+            for (; high > 0; high &= high - 1) {
+                sum += tree[high];
+            }
+            for (; low > 0; low &= low - 1) {
+                sum -= tree[low];
+            }
+            return sum;
+        }
+    };
+
+    static void seekKernelScalar(const uint32_t* blocks, size_t begin, size_t end, SeekProfile& profile) {
+        for (size_t i = max<size_t>(begin, 1); i < end; i++) {
+            uint32_t distance = blocks[i] > blocks[i - 1] ? blocks[i] - blocks[i - 1] : blocks[i - 1] - blocks[i];
+            profile.total += distance;
+            profile.longest = max(profile.longest, distance);
+            profile.buckets[LogLinearBuckets::indexOf(distance)]++;
+        }
+        profile.requests += end > max<size_t>(begin, 1) ? end - max<size_t>(begin, 1) : 0;
+    }
+
+#ifdef HAVE_AVX2_KERNELS
+    // Eight distances per step: absolute differences, their bucket indexes
+    // (the top bit comes from the float exponent, corrected for rounding),
+    // 64-bit sums and the running maximum stay in vector registers; only the
+    // bucket increments are scalar. Each lane counts into its own table so
+    // runs of equal distances do not serialize on one counter.
+    __attribute__((target("avx2"))) static void seekKernelAVX2(const uint32_t* blocks, size_t begin, size_t end,
+                                                               SeekProfile& profile) {
+        static_assert(LogLinearBuckets::SUB_BITS == 3, "vector bucket index assumes 8 sub-buckets");
+        size_t i = max<size_t>(begin, 1);
+        __m256i sum_low = _mm256_setzero_si256(), sum_high = _mm256_setzero_si256(), longest = _mm256_setzero_si256();
+        const __m256i three = _mm256_set1_epi32(3), seven = _mm256_set1_epi32(7);
+        const __m256i sub_base = _mm256_set1_epi32(2 * LogLinearBuckets::SUB_BUCKETS);
+        alignas(32) uint32_t indexes[8];
+        vector<uint32_t> lane_counts(8 * LogLinearBuckets::COUNT, 0); // Chunks stay below 2^32 rows
+        uint32_t* counts = lane_counts.data();
+        size_t start = i;
+        for (; i + 8 <= end; i += 8) {
+            __m256i current = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i));
+            __m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(blocks + i - 1));
+            __m256i distance = _mm256_sub_epi32(_mm256_max_epu32(current, previous), _mm256_min_epu32(current, previous));
+            sum_low = _mm256_add_epi64(sum_low, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(distance)));
+            sum_high = _mm256_add_epi64(sum_high, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(distance, 1)));
+            longest = _mm256_max_epu32(longest, distance);
+
+            // top = floor(log2(distance)) for distance >= 2, from the exponent of (distance >> 1) + 1
+            __m256i halved = _mm256_srli_epi32(distance, 1);
+            __m256i exponent = _mm256_srli_epi32(_mm256_castps_si256(_mm256_cvtepi32_ps(halved)), 23);
+            __m256i top = _mm256_sub_epi32(exponent, _mm256_set1_epi32(126));
+            __m256i overshot = _mm256_cmpeq_epi32(_mm256_srlv_epi32(distance, top), _mm256_setzero_si256());
+            top = _mm256_add_epi32(top, overshot); // Rounding up to the next power of two: step back
+            __m256i sub = _mm256_and_si256(_mm256_srlv_epi32(distance, _mm256_sub_epi32(top, three)), seven);
+            __m256i index = _mm256_add_epi32(_mm256_sub_epi32(_mm256_slli_epi32(top, 3), sub_base), sub);
+            __m256i small = _mm256_cmpeq_epi32(_mm256_min_epu32(distance, seven), distance);
+            index = _mm256_blendv_epi8(index, distance, small);
+            _mm256_store_si256(reinterpret_cast<__m256i*>(indexes), index);
+            for (int lane = 0; lane < 8; lane++) {
+                counts[lane * LogLinearBuckets::COUNT + indexes[lane]]++;
+            }
+        }
+        for (int lane = 0; lane < 8; lane++) {
+            for (int bucket = 0; bucket < LogLinearBuckets::COUNT; bucket++) {
+                profile.buckets[bucket] += counts[lane * LogLinearBuckets::COUNT + bucket];
+            }
+        }
+        alignas(32) uint64_t sums[8];
+        alignas(32) uint32_t maxima[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums), sum_low);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(sums + 4), sum_high);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(maxima), longest);
+        for (int lane = 0; lane < 8; lane++) {
+            profile.total += sums[lane];
+            profile.longest = max(profile.longest, maxima[lane]);
+        }
+        profile.requests += i - start;
+        seekKernelScalar(blocks, i, end, profile); // Tail
+    }
+#endif
+
 public:
-    ProcessTable() : next_pid(1) {}
-    
-    int createProcess(const string& transaction_id) {
-        lock_guard<mutex> lock(table_mutex);
-        ProcessControlBlock pcb(next_pid++, transaction_id);
-        pcb.status = "READY";
-        processes.push_back(pcb);
-        cout << "[PROCESS TABLE] Created Process PID: " << pcb.pid << " for Transaction: " << transaction_id << endl;
-        return pcb.pid;
+    static bool simdAvailable() {
+#ifdef HAVE_AVX2_KERNELS
+        return __builtin_cpu_supports("avx2");
+#else
+        return false;
+#endif
     }
-    
-    void updateStatus(int pid, const string& new_status) {
-        lock_guard<mutex> lock(table_mutex);
-        for (auto& pcb : processes) {
-            if (pcb.pid == pid) {
-                pcb.status = new_status;
-                cout << "[PROCESS TABLE] PID " << pid << " status: " << new_status << endl;
-                break;
+
+    // Exact reuse distances in two passes. Each chunk first resolves the
+    // references whose previous use lies inside it (Fenwick tree over the
+    // chunk's positions) and lists its pages in order of first and of last
+    // occurrence. A sequential stitch then resolves first-in-chunk
+    // references against the earlier chunks' last occurrences ("events").
+    // Chunks run in waves of two per worker so only a wave's lists are held.
+    static ReuseProfile reuseDistances(const uint32_t* pages, uint64_t rows, uint64_t cardinality, unsigned threads,
+                                       size_t chunk_rows = CHUNK_ROWS) {
+        ReuseProfile profile;
+        profile.references = rows;
+        size_t chunk_count = (size_t)((rows + chunk_rows - 1) / chunk_rows);
+        unsigned workers = workerCount(threads, chunk_count, cardinality);
+        size_t wave = 2 * (size_t)workers;
+        vector<vector<uint32_t>> first_pages(wave), last_pages(wave);
+        vector<vector<uint32_t>> last_use(workers);
+        vector<Fenwick> marks(workers);
+        vector<vector<uint64_t>> buckets(workers, vector<uint64_t>(LogLinearBuckets::COUNT));
+
+        // Stitch state. Each page has at most one live event, so once the
+        // numbering runs out the live events are renumbered densely.
+        const uint32_t NONE = UINT32_MAX;
+        size_t capacity = (size_t)(2 * cardinality + min<uint64_t>(chunk_rows, cardinality));
+        Fenwick superseded;
+        superseded.reset(capacity);
+        vector<uint32_t> event_of((size_t)cardinality, NONE);
+        uint32_t base = 0;
+
+        for (size_t wave_start = 0; wave_start < chunk_count; wave_start += wave) {
+            size_t wave_chunks = min(wave, chunk_count - wave_start);
+            forEachChunk(wave_chunks, workers, [&](size_t slot, unsigned worker) {
+                uint64_t begin = (wave_start + slot) * chunk_rows;
+                size_t length = (size_t)min<uint64_t>(chunk_rows, rows - begin);
+                const uint32_t* chunk_pages = pages + begin;
+                vector<uint32_t>& last = last_use[worker]; // Position in the chunk + 1; 0 = not seen
+                if (last.empty()) {
+                    last.assign((size_t)cardinality, 0);
+                }
+                Fenwick& replaced = marks[worker]; // Positions whose page was referenced again
+                replaced.reset(length);
+                uint64_t* counts = buckets[worker].data();
+                vector<uint32_t>& firsts = first_pages[slot];
+                firsts.clear();
+                for (size_t i = 0; i < length; i++) {
+                    uint32_t page = chunk_pages[i];
+                    uint32_t previous = last[page];
+                    if (previous) {
+                        // Positions in between still holding their page's latest use are distinct pages
+                        counts[LogLinearBuckets::indexOf(i - previous - replaced.count(previous, i))]++;
+                        replaced.mark(previous - 1);
+                    } else {
+                        firsts.push_back(page);
+                    }
+                    last[page] = (uint32_t)i + 1;
+                }
+                vector<pair<uint32_t, uint32_t>> lasts; // (position, page)
+                lasts.reserve(firsts.size());
+                for (uint32_t page : firsts) {
+                    lasts.push_back({last[page], page});
+                    last[page] = 0;
+                }
+                sort(lasts.begin(), lasts.end());
+                last_pages[slot].clear();
+                for (const auto& entry : lasts) {
+                    last_pages[slot].push_back(entry.second);
+                }
+            });
+
+            for (size_t slot = 0; slot < wave_chunks; slot++) {
+                if (base + last_pages[slot].size() > capacity) {
+                    vector<pair<uint32_t, uint32_t>> live; // (event, page); every event is live here
+                    for (uint32_t page = 0; page < cardinality; page++) {
+                        if (event_of[page] != NONE) {
+                            live.push_back({event_of[page], page});
+                        }
+                    }
+                    sort(live.begin(), live.end());
+                    for (size_t i = 0; i < live.size(); i++) {
+                        event_of[live[i].second] = (uint32_t)i;
+                    }
+                    superseded.reset(capacity);
+                    base = (uint32_t)live.size();
+                }
+                uint64_t seen_in_chunk = 0;
+                for (uint32_t page : first_pages[slot]) {
+                    uint32_t event = event_of[page];
+                    if (event == NONE) {
+                        profile.cold++;
+                    } else {
+                        uint64_t others = base - event - 1 - superseded.count(event + 1, base) + seen_in_chunk;
+                        profile.buckets[LogLinearBuckets::indexOf(others)]++;
+                        superseded.mark(event);
+                    }
+                    seen_in_chunk++;
+                }
+                for (uint32_t page : last_pages[slot]) {
+                    event_of[page] = base++;
+                }
             }
         }
-    }
-    
-    void setWaitingTime(int pid, int wtime) {
-        lock_guard<mutex> lock(table_mutex);
-        for (auto& pcb : processes) {
-            if (pcb.pid == pid) {
-                pcb.waiting_time = wtime;
-                break;
+        for (const auto& worker_buckets : buckets) {
+            for (int i = 0; i < LogLinearBuckets::COUNT; i++) {
+                profile.buckets[i] += worker_buckets[i];
             }
         }
+        return profile;
     }
-    
-    void displayProcessTable() {
-        lock_guard<mutex> lock(table_mutex);
-        cout << "\n=== PROCESS TABLE ===" << endl;
-        cout << setw(6) << "PID" << setw(15) << "Transaction" << setw(12) << "Status" 
-             << setw(10) << "Wait Time" << endl;
-        cout << string(50, '-') << endl;
-        for (const auto& pcb : processes) {
-            cout << setw(6) << pcb.pid << setw(15) << pcb.transaction_id 
-                 << setw(12) << pcb.status << setw(10) << pcb.waiting_time << endl;
-        }
+
+    // Distinct pages in each run of window consecutive references
+    static WorkingSetProfile workingSet(const uint32_t* pages, uint64_t rows, uint64_t cardinality, uint64_t window,
+                                        unsigned threads, size_t chunk_rows = CHUNK_ROWS) {
+        WorkingSetProfile profile;
+        profile.window = max<uint64_t>(1, window);
+        size_t window_count = (size_t)((rows + profile.window - 1) / profile.window);
+        profile.sizes.assign(window_count, 0);
+        size_t windows_per_chunk = (size_t)max<uint64_t>(1, chunk_rows / profile.window);
+        size_t chunk_count = (window_count + windows_per_chunk - 1) / windows_per_chunk;
+        unsigned workers = workerCount(threads, chunk_count, cardinality);
+        vector<vector<uint32_t>> stamps(workers); // Window index + 1 of the page's last sighting
+
+        forEachChunk(chunk_count, workers, [&](size_t chunk, unsigned worker) {
+            vector<uint32_t>& stamp = stamps[worker];
+            if (stamp.empty()) {
+                stamp.assign((size_t)cardinality, 0);
+            }
+            size_t last_window = min(window_count, (chunk + 1) * windows_per_chunk);
+            for (size_t w = chunk * windows_per_chunk; w < last_window; w++) {
+                uint64_t begin = w * profile.window;
+                uint64_t end = min(rows, begin + profile.window);
+                uint32_t mark = (uint32_t)w + 1;
+                uint32_t distinct = 0;
+                for (uint64_t i = begin; i < end; i++) {
+                    if (stamp[pages[i]] != mark) {
+                        stamp[pages[i]] = mark;
+                        distinct++;
+                    }
+                }
+                profile.sizes[w] = distinct;
+            }
+        });
+        return profile;
     }
-    
-    vector<ProcessControlBlock> getProcesses() {
-        lock_guard<mutex> lock(table_mutex);
-        return processes;
+
+    static SeekProfile seekDistances(const uint32_t* blocks, uint64_t rows, unsigned threads, bool use_simd = true,
+                                     size_t chunk_rows = CHUNK_ROWS) {
+        size_t chunk_count = (size_t)((rows + chunk_rows - 1) / chunk_rows);
+        unsigned workers = workerCount(threads, chunk_count);
+        vector<SeekProfile> partial(workers);
+        bool simd = use_simd && simdAvailable();
+        forEachChunk(chunk_count, workers, [&](size_t chunk, unsigned worker) {
+            size_t begin = chunk * chunk_rows;
+            size_t end = (size_t)min<uint64_t>(rows, begin + chunk_rows);
+#ifdef HAVE_AVX2_KERNELS
+            if (simd) {
+                seekKernelAVX2(blocks, begin, end, partial[worker]);
+                return;
+            }
+#endif
+            seekKernelScalar(blocks, begin, end, partial[worker]);
+        });
+        SeekProfile profile;
+        for (const auto& part : partial) {
+            profile.merge(part);
+        }
+        return profile;
     }
-};
 
-// --- Account Management ---
-class AccountManager {
-private:
-    map<string, double> accounts;
-    mutex account_mutex;
-    const string ACCOUNT_FILE = "accounts.txt";
+    // Total head movement of each disk policy when the request stream is
+    // served queue_depth requests at a time. Each batch starts with the head
+    // on the request before it. Batches are sampled evenly, at most 65536.
+    static vector<PolicySeek> compareDiskPolicies(const uint32_t* blocks, uint64_t rows, uint64_t disk_size,
+                                                  size_t queue_depth, unsigned threads, uint64_t& sampled_requests) {
+        const size_t MAX_BATCHES = 65536;
+        const size_t POLICIES = DiskManager::ALGORITHM_COUNT + 1;
+        queue_depth = max<size_t>(1, queue_depth);
+        size_t batch_count = (size_t)(rows / queue_depth);
+        size_t stride = max<size_t>(1, (batch_count + MAX_BATCHES - 1) / MAX_BATCHES);
+        size_t sampled = (batch_count + stride - 1) / stride;
+        sampled_requests = sampled * queue_depth;
+        const size_t BATCHES_PER_CHUNK = 256;
+        size_t chunk_count = (sampled + BATCHES_PER_CHUNK - 1) / BATCHES_PER_CHUNK;
+        unsigned workers = workerCount(threads, chunk_count);
+        vector<vector<long long>> totals(workers, vector<long long>(POLICIES, 0));
 
-    // Helper function to load accounts from the file
-    void loadAccountsFromFile() {
-        ifstream infile(ACCOUNT_FILE);
-        if (!infile.is_open()) {
-            return; // File does not exist, nothing to load
+        forEachChunk(chunk_count, workers, [&](size_t chunk, unsigned worker) {
+            vector<int> queue(queue_depth);
+            size_t last_batch = min(sampled, (chunk + 1) * BATCHES_PER_CHUNK);
+            for (size_t b = chunk * BATCHES_PER_CHUNK; b < last_batch; b++) {
+                size_t begin = b * stride * queue_depth;
+                int head = begin ? (int)blocks[begin - 1] : 0;
+                for (size_t i = 0; i < queue_depth; i++) {
+                    queue[i] = (int)blocks[begin + i];
+                }
+                for (size_t policy = 0; policy < POLICIES; policy++) {
+                    DiskScheduleResult result = policy == 0
+                        ? DiskManager::scheduleFCFS(queue, head)
+                        : DiskManager::schedule((int)policy - 1, queue, head, (int)max<uint64_t>(1, disk_size));
+                    totals[worker][policy] += result.total_seek;
+                }
+            }
+        });
+        vector<PolicySeek> results(POLICIES);
+        for (size_t policy = 0; policy < POLICIES; policy++) {
+            results[policy].algorithm = policy == 0 ? DiskManager::scheduleFCFS({}, 0).algorithm
+                                                    : DiskManager::schedule((int)policy - 1, {}, 0, 1).algorithm;
+            for (const auto& worker_totals : totals) {
+                results[policy].total_seek += worker_totals[policy];
+            }
         }
+        return results;
+    }
 
-        accounts.clear();
-        string account_id;
-        double balance;
-        while (infile >> account_id >> balance) {
-            accounts[account_id] = balance;
+private:
+    // Histogram rows by power of two: 0, 1, 2-3, 4-7, ...
+    static void printDistribution(const vector<uint64_t>& buckets, const string& label) {
+        uint64_t total = 0;
+        for (uint64_t count : buckets) {
+            total += count;
+        }
+        if (total == 0) {
+            return;
         }
-        infile.close();
+        cout << setw(22) << label << setw(16) << "Count" << setw(14) << "Cumulative" << endl;
+        uint64_t cumulative = 0;
+        for (int bit = -1; bit < LogLinearBuckets::MAX_BIT && cumulative < total; bit++) {
+            uint64_t low = bit < 0 ? 0 : uint64_t(1) << bit;
+            uint64_t high = bit < 0 ? 0 : (uint64_t(1) << (bit + 1)) - 1;
+            uint64_t count = 0;
+            for (int i = LogLinearBuckets::indexOf(low); i <= LogLinearBuckets::indexOf(high); i++) {
+                count += buckets[i];
+            }
+            cumulative += count;
+            if (count == 0) {
+                continue;
+            }
+            string range = low == high ? to_string(low) : to_string(low) + "-" + to_string(high);
+            cout << setw(22) << range << setw(16) << count << setw(13) << fixed << setprecision(2)
+                 << 100.0 * cumulative / total << "%" << endl;
+        }
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
     }
 
-    // Helper function to save all accounts to the file
-    void saveAccountsToFile() {
-        ofstream outfile(ACCOUNT_FILE, ios::trunc);
-        for (const auto& entry : accounts) {
-            outfile << entry.first << " " << entry.second << endl;
+    static void printThroughput(const string& name, uint64_t rows, double seconds) {
+        cout << fixed << setprecision(3) << name << ": " << seconds << " s";
+        if (seconds > 0) {
+            cout << setprecision(1) << " (" << rows / seconds / 1e6 << "M rows/s, " << setprecision(2)
+                 << rows * sizeof(uint32_t) / seconds / 1e9 << " GB/s per column)";
         }
-        outfile.close();
+        cout << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
     }
 
 public:
-    AccountManager() {
-        loadAccountsFromFile(); // Load accounts when the system starts
-    }
+    // Full report for a columnar trace: reuse distances with the LRU fault
+    // rate per frame count, working sets per window of references, seek
+    // distances and disk policies at the given queue depth
+    static bool analyze(const string& path, uint64_t window, size_t queue_depth) {
+        ColumnarTrace trace;
+        if (!trace.open(path)) {
+            cout << "Cannot open columnar trace " << path << endl;
+            return false;
+        }
+        unsigned threads = max(1u, thread::hardware_concurrency());
+        uint64_t rows = trace.rows();
+        uint64_t page_count = 0, disk_size = 0;
+        const uint32_t* pages = trace.column("page", page_count);
+        const uint32_t* blocks = trace.column("block", disk_size);
+        cout << "\n=== TRACE ANALYSIS ===" << endl;
+        cout << "Trace: " << path << " (" << rows << " rows";
+        if (pages) {
+            cout << ", " << page_count << " pages";
+        }
+        if (blocks) {
+            cout << ", " << disk_size << " blocks";
+        }
+        cout << ")" << endl;
+        cout << "Threads: " << threads << ", seek kernel: " << (simdAvailable() ? "AVX2" : "scalar") << endl;
+        if (!pages && !blocks) {
+            cout << "No page or block column" << endl;
+            return false;
+        }
 
-    void createAccount(const string& account_id, double initial_balance) {
-        lock_guard<mutex> lock(account_mutex);
+        if (pages) {
+            auto start = chrono::steady_clock::now();
+            ReuseProfile reuse = reuseDistances(pages, rows, page_count, threads);
+            double reuse_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "\n--- Reuse Distance ---" << endl;
+            cout << "Cold references: " << reuse.cold << endl;
+            printDistribution(reuse.buckets, "Pages Between Uses");
+            cout << "\n" << setw(12) << "Frames" << setw(16) << "LRU Faults" << setw(14) << "Fault Rate" << endl;
+            for (uint64_t frames = 1;; frames *= 2) {
+                uint64_t faults = reuse.lruFaults(frames);
+                cout << setw(12) << frames << setw(16) << faults << setw(13) << fixed << setprecision(3)
+                     << (rows ? 100.0 * faults / rows : 0.0) << "%" << endl;
+                if (faults == reuse.cold || frames >= page_count) {
+                    break;
+                }
+            }
+            cout.unsetf(ios::floatfield);
+            cout << setprecision(6);
+            printThroughput("Reuse analysis", rows, reuse_seconds);
 
-        if (accounts.find(account_id) != accounts.end()) {
-            cout << "Account ID already exists!" << endl;
-            return;
+            start = chrono::steady_clock::now();
+            WorkingSetProfile working = workingSet(pages, rows, page_count, window, threads);
+            double working_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "\n--- Working Set (window of " << working.window << " references) ---" << endl;
+            vector<uint32_t> sorted = working.sizes;
+            sort(sorted.begin(), sorted.end());
+            if (!sorted.empty()) {
+                double mean = 0;
+                for (uint32_t size : sorted) {
+                    mean += size;
+                }
+                mean /= sorted.size();
+                cout << "Windows: " << sorted.size() << "  Min: " << sorted.front() << "  Mean: " << fixed
+                     << setprecision(1) << mean << "  P95: " << sorted[(sorted.size() - 1) * 95 / 100]
+                     << "  Max: " << sorted.back() << endl;
+                cout.unsetf(ios::floatfield);
+                cout << setprecision(6);
+                const size_t SAMPLES = 10;
+                for (size_t s = 0; s < min(SAMPLES, working.sizes.size()); s++) {
+                    size_t w = s * (working.sizes.size() - 1) / max<size_t>(1, min(SAMPLES, working.sizes.size()) - 1);
+                    cout << "  From reference " << setw(12) << w * working.window << ": " << working.sizes[w]
+                         << " pages" << endl;
+                }
+            }
+            printThroughput("Working set analysis", rows, working_seconds);
         }
 
-        accounts[account_id] = initial_balance;
+        if (blocks) {
+            auto start = chrono::steady_clock::now();
+            SeekProfile seeks = seekDistances(blocks, rows, threads);
+            double seek_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "\n--- Seek Distance ---" << endl;
+            cout << "Total: " << seeks.total << "  Mean: " << fixed << setprecision(1)
+                 << (seeks.requests ? (double)seeks.total / seeks.requests : 0.0) << "  Max: " << seeks.longest
+                 << endl;
+            cout.unsetf(ios::floatfield);
+            cout << setprecision(6);
+            printDistribution(seeks.buckets, "Blocks Moved");
+            printThroughput("Seek analysis", rows, seek_seconds);
 
-        // Append the new account to the file
-        ofstream outfile(ACCOUNT_FILE, ios::app);
-        if (outfile.is_open()) {
-            outfile << account_id << " " << initial_balance << endl;
-            outfile.close();
+            uint64_t sampled = 0;
+            start = chrono::steady_clock::now();
+            vector<PolicySeek> policies = compareDiskPolicies(blocks, rows, disk_size, queue_depth, threads, sampled);
+            double policy_seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            cout << "\n--- Disk Policies (queue depth " << max<size_t>(1, queue_depth) << ", " << sampled
+                 << " requests sampled) ---" << endl;
+            auto best = min_element(policies.begin(), policies.end(), [](const PolicySeek& a, const PolicySeek& b) {
+                return a.total_seek < b.total_seek;
+            });
+            for (const auto& policy : policies) {
+                cout << setw(10) << policy.algorithm << setw(18) << policy.total_seek << setw(12) << fixed
+                     << setprecision(1) << (sampled ? (double)policy.total_seek / sampled : 0.0)
+                     << (&policy == &*best ? "  <- best" : "") << endl;
+            }
+            cout.unsetf(ios::floatfield);
+            cout << setprecision(6);
+            printThroughput("Policy comparison", sampled, policy_seconds);
         }
-
-        cout << "Account created for " << account_id << " with balance: " << initial_balance << endl;
+        return true;
     }
+};
+
+// --- Inter-Process Communication ---
+// Bounded lock-free multi-producer/multi-consumer ring buffer (Vyukov).
+// Every cell carries a sequence number that tells producers and consumers
+// whether it is free for the current lap, so the only shared writes are one
+// CAS on the enqueue or dequeue index. The algorithm works on caller-owned
+// cells so the same code drives heap queues and shared-memory rings.
+template <typename T>
+struct alignas(64) MPMCCell {
+    atomic<size_t> sequence;
+    T data;
+};
 
-    void deposit(const string& account_id, double amount) {
-        lock_guard<mutex> lock(account_mutex);
-        if (accounts.find(account_id) != accounts.end()) {
-            accounts[account_id] += amount;
-            saveAccountsToFile(); // Update the file with the new balance
-            cout << "Deposited " << amount << " to account " << account_id << endl;
+// fill(T&) writes the message straight into the claimed cell.
+// Returns false when the ring is full.
+template <typename T, typename Fill>
+bool mpmcTryEmplace(MPMCCell<T>* cells, size_t mask, atomic<size_t>& enqueue_pos, Fill fill) {
+    size_t pos = enqueue_pos.load(memory_order_relaxed);
+    MPMCCell<T>* cell;
+    while (true) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (enqueue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;
         } else {
-            cout << "Account " << account_id << " not found!" << endl;
+            pos = enqueue_pos.load(memory_order_relaxed);
         }
     }
+    fill(cell->data);
+    cell->sequence.store(pos + 1, memory_order_release);
+    return true;
+}
 
-    void withdraw(const string& account_id, double amount) {
-        lock_guard<mutex> lock(account_mutex);
-        if (accounts.find(account_id) != accounts.end()) {
-            if (accounts[account_id] >= amount) {
-                accounts[account_id] -= amount;
-                saveAccountsToFile(); // Update the file with the new balance
-                cout << "Withdrew " << amount << " from account " << account_id << endl;
-            } else {
-                cout << "Insufficient balance in account " << account_id << endl;
+// consume(const T&) reads the message in place before the cell is released.
+// Returns false when the ring is empty.
+template <typename T, typename Consume>
+bool mpmcTryConsume(MPMCCell<T>* cells, size_t mask, atomic<size_t>& dequeue_pos, Consume consume) {
+    size_t pos = dequeue_pos.load(memory_order_relaxed);
+    MPMCCell<T>* cell;
+    while (true) {
+        cell = &cells[pos & mask];
+        size_t seq = cell->sequence.load(memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (dequeue_pos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                break;
             }
+        } else if (diff < 0) {
+            return false;
         } else {
-            cout << "Account " << account_id << " not found!" << endl;
+            pos = dequeue_pos.load(memory_order_relaxed);
         }
     }
+    consume(static_cast<const T&>(cell->data));
+    cell->sequence.store(pos + mask + 1, memory_order_release);
+    return true;
+}
 
-    void checkBalance(const string& account_id) {
-        lock_guard<mutex> lock(account_mutex);
-        if (accounts.find(account_id) != accounts.end()) {
-            cout << "Balance for account " << account_id << ": " << accounts[account_id] << endl;
-        } else {
-            cout << "Account " << account_id << " not found!" << endl;
+template <typename T>
+class MPMCQueue {
+private:
+    unique_ptr<MPMCCell<T>[]> cells;
+    size_t mask;
+    alignas(64) atomic<size_t> enqueue_pos;
+    alignas(64) atomic<size_t> dequeue_pos;
+
+public:
+    // Capacity is rounded up to a power of two
+    explicit MPMCQueue(size_t capacity) : enqueue_pos(0), dequeue_pos(0) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
         }
+        cells.reset(new MPMCCell<T>[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            cells[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+
+    MPMCQueue(const MPMCQueue&) = delete;
+    MPMCQueue& operator=(const MPMCQueue&) = delete;
+
+    template <typename Fill>
+    bool tryEmplace(Fill fill) {
+        return mpmcTryEmplace(cells.get(), mask, enqueue_pos, fill);
+    }
+
+    bool tryPush(const T& value) {
+        return tryEmplace([&value](T& slot) { slot = value; });
+    }
+
+    template <typename Consume>
+    bool tryConsume(Consume consume) {
+        return mpmcTryConsume(cells.get(), mask, dequeue_pos, consume);
+    }
+
+    bool tryPop(T& value) {
+        return tryConsume([&value](const T& slot) { value = slot; });
+    }
+
+    // Exact when the queue is quiescent, approximate under concurrent use
+    size_t approxSize() const {
+        size_t head = dequeue_pos.load(memory_order_relaxed);
+        size_t tail = enqueue_pos.load(memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
     }
 };
 
-// --- Transaction Management ---
-class TransactionManager {
+// Lets consumers of a lock-free queue sleep. A consumer parks only after
+// finding the queue empty, and a producer touches the mutex only when a
+// consumer is parked, so the uncontended path stays lock-free. The seq_cst
+// fences order "publish message / check waiters" against "register waiter /
+// re-check queue", so a wakeup cannot be lost.
+class Doorbell {
 private:
-    AccountManager* account_manager;
-    ProcessTable* process_table;
+    atomic<int> waiters;
+    mutex bell_mutex;
+    condition_variable bell_cv;
+    unsigned long long epoch;
 
 public:
-    TransactionManager(AccountManager* am, ProcessTable* pt) 
-        : account_manager(am), process_table(pt) {}
+    Doorbell() : waiters(0), epoch(0) {}
 
-    void createTransaction(const string& id, const string& action, const string& account_id, double amount = 0, int pid = 0) {
-        if (pid > 0 && process_table) {
-            process_table->updateStatus(pid, "RUNNING");
-        }
-        
-        cout << "Transaction " << id << " started" << endl;
-        if (action == "deposit") {
-            account_manager->deposit(account_id, amount);
-        } else if (action == "withdraw") {
-            account_manager->withdraw(account_id, amount);
-        } else if (action == "balance") {
-            account_manager->checkBalance(account_id);
+    void ring() {
+        atomic_thread_fence(memory_order_seq_cst);
+        if (waiters.load(memory_order_relaxed) > 0) {
+            {
+                lock_guard<mutex> lock(bell_mutex);
+                epoch++;
+            }
+            bell_cv.notify_all();
         }
-        cout << "Transaction " << id << " completed" << endl;
-        
-        if (pid > 0 && process_table) {
-            process_table->updateStatus(pid, "COMPLETED");
+    }
+
+    // Retry try_fn until it succeeds or the deadline passes
+    template <typename TryFn>
+    bool waitUntil(TryFn try_fn, chrono::steady_clock::time_point deadline) {
+        while (true) {
+            if (try_fn()) {
+                return true;
+            }
+            unique_lock<mutex> lock(bell_mutex);
+            waiters.fetch_add(1, memory_order_seq_cst);
+            atomic_thread_fence(memory_order_seq_cst);
+            unsigned long long seen = epoch;
+            if (try_fn()) {
+                waiters.fetch_sub(1, memory_order_relaxed);
+                return true;
+            }
+            bool rung = bell_cv.wait_until(lock, deadline, [&] { return epoch != seen; });
+            waiters.fetch_sub(1, memory_order_relaxed);
+            if (!rung) {
+                lock.unlock();
+                return try_fn(); // Timed out: one last look
+            }
+            // Rung: retry, another consumer may have taken the message first
         }
     }
 };
 
-// --- CPU Scheduling ---
-class CPUScheduler {
-private:
-    TransactionManager* transaction_manager;
-    ProcessTable* process_table;
-    const int TIME_QUANTUM = 2;
+enum class MessageKind : int { DATA, SYNC, ASYNC, NOTIFICATION };
 
-public:
-    CPUScheduler(TransactionManager* tm, ProcessTable* pt) 
-        : transaction_manager(tm), process_table(pt) {}
+// Fixed-size message slot: no heap allocation on send. Text longer than
+// MAX_TEXT bytes is truncated.
+struct IPCMessage {
+    static constexpr size_t MAX_TEXT = 224;
+    static const uint32_t NO_REPLY = UINT32_MAX;
 
-    void simulateRoundRobin(const vector<tuple<string, string, string, double>>& transactions) {
-        cout << "\n=== ROUND ROBIN CPU SCHEDULING (Time Quantum = " << TIME_QUANTUM << ") ===\n";
-        cout << "\nGantt Chart:\n";
-        cout << setw(10) << "PID" << setw(15) << "Transaction" << setw(15) << "Start Time" 
-             << setw(15) << "End Time" << setw(15) << "Wait Time" << endl;
-        cout << string(70, '-') << endl;
+    int source_pid;
+    int target_pid;
+    MessageKind kind;
+    uint32_t length;
+    uint32_t reply_slot;       // SYNC messages: where the acknowledgment goes
+    uint32_t reply_generation; // Guards against replies to an abandoned request
+    char text[MAX_TEXT];
 
-        int time = 0;
-        int total_waiting_time = 0;
-        int total_turnaround_time = 0;
-        vector<int> pids;
-        
-        for (const auto& transaction : transactions) {
-            string id, action, account_id;
-            double amount;
-            tie(id, action, account_id, amount) = transaction;
+    void fill(int source, int target, MessageKind message_kind, const char* data, size_t size) {
+        source_pid = source;
+        target_pid = target;
+        kind = message_kind;
+        length = (uint32_t)min(size, MAX_TEXT);
+        reply_slot = NO_REPLY;
+        reply_generation = 0;
+        memcpy(text, data, length);
+    }
 
-            // Create process
-            int pid = process_table->createProcess(id);
-            pids.push_back(pid);
-            
-            int start_time = time;
-            int waiting_time = start_time;
-            
-            cout << setw(10) << pid << setw(15) << id << setw(15) << start_time 
-                 << setw(15) << (start_time + TIME_QUANTUM) << setw(15) << waiting_time << endl;
-
-            process_table->setWaitingTime(pid, waiting_time);
-            
-            thread t(&TransactionManager::createTransaction, transaction_manager, 
-                    id, action, account_id, amount, pid);
-            t.join();
-            
-            time += TIME_QUANTUM;
-            total_waiting_time += waiting_time;
-            total_turnaround_time += (time);
+    string body() const {
+        return string(text, length);
+    }
+
+    // Display form, built only when a message is printed
+    string format() const {
+        switch (kind) {
+        case MessageKind::DATA:
+            return "[PID " + to_string(source_pid) + " -> PID " + to_string(target_pid) + "]: " + body();
+        case MessageKind::NOTIFICATION:
+            return "Process " + to_string(source_pid) + " has completed";
+        default:
+            return body();
         }
-        
-        // Calculate metrics
-        double avg_waiting_time = (double)total_waiting_time / transactions.size();
-        double avg_turnaround_time = (double)total_turnaround_time / transactions.size();
-        double cpu_utilization = ((double)transactions.size() * TIME_QUANTUM / time) * 100;
-        
-        cout << "\n=== CPU SCHEDULING METRICS ===" << endl;
-        cout << "Total Processes: " << transactions.size() << endl;
-        cout << "Average Waiting Time: " << fixed << setprecision(2) << avg_waiting_time << " units" << endl;
-        cout << "Average Turnaround Time: " << avg_turnaround_time << " units" << endl;
-        cout << "CPU Utilization: " << cpu_utilization << "%" << endl;
-        cout << "Total CPU Time: " << time << " units" << endl;
-        
-        process_table->displayProcessTable();
     }
 };
 
-// --- Memory Management ---
-class MemoryManager {
+// A lock-free queue plus the doorbell its blocking consumers sleep on
+struct MessageChannel {
+    MPMCQueue<IPCMessage> queue;
+    Doorbell doorbell;
+
+    explicit MessageChannel(size_t capacity) : queue(capacity) {}
+
+    template <typename Fill>
+    bool send(Fill fill) {
+        if (!queue.tryEmplace(fill)) {
+            return false;
+        }
+        doorbell.ring();
+        return true;
+    }
+
+    bool receive(IPCMessage& message, chrono::milliseconds timeout) {
+        return doorbell.waitUntil([&] { return queue.tryPop(message); },
+                                  chrono::steady_clock::now() + timeout);
+    }
+};
+
+// Cross-process transport: one lock-free ring per PID in a POSIX shared
+// memory segment (shm_open + mmap), so separate OS processes exchange
+// messages without copying through the kernel. Senders write messages in
+// place and receivers read them in place. Blocked receivers sleep on a
+// futex in the ring and are woken only when someone is waiting. Linux only.
+class SharedMemoryTransport {
+public:
+    static const int MAX_PROCESSES = 64;    // Valid PIDs: 1 .. MAX_PROCESSES - 1
+    static const size_t RING_CAPACITY = 256; // Power of two
+
 private:
-    map<int, string> memory_map;
-    deque<int> page_order;
-    const int MAX_PAGES = 3;
+    static const uint32_t SEGMENT_MAGIC = 0x4F534950; // "OSIP"
+    static constexpr int INIT_TIMEOUT_MS = 5000; // Longest wait for another process to initialize
+    enum SegmentState : uint32_t { UNINITIALIZED = 0, INITIALIZING = 1, READY = 2 };
+
+    struct SharedRing {
+        alignas(64) atomic<size_t> enqueue_pos;
+        alignas(64) atomic<size_t> dequeue_pos;
+        alignas(64) atomic<uint32_t> futex_word;
+        atomic<uint32_t> waiters;
+        MPMCCell<IPCMessage> cells[RING_CAPACITY];
+    };
+
+    struct SharedSegment {
+        atomic<uint32_t> state;
+        uint32_t magic;
+        SharedRing rings[MAX_PROCESSES];
+    };
+
+    static_assert(atomic<size_t>::is_always_lock_free && atomic<uint32_t>::is_always_lock_free,
+                  "shared-memory rings need address-free atomics");
+
+    SharedSegment* segment = nullptr;
+    string segment_name;
+
+    SharedRing* ringFor(int pid) const {
+        return (segment && pid > 0 && pid < MAX_PROCESSES) ? &segment->rings[pid] : nullptr;
+    }
+
+#ifdef __linux__
+    static long futex(atomic<uint32_t>* word, int op, uint32_t value, const timespec* timeout) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(word), op, value, timeout, nullptr, 0);
+    }
+#endif
 
 public:
-    void accessMemoryPage(int page_id, const string& data) {
-        auto it = find(page_order.begin(), page_order.end(), page_id);
-        if (it != page_order.end()) {
-            page_order.erase(it);
+    ~SharedMemoryTransport() {
+        detach();
+    }
+
+    // Map (and create if needed) the named segment. The first process to
+    // attach initializes the rings; later ones wait until it is ready.
+    bool attach(const string& name) {
+#ifdef __linux__
+        detach();
+        int fd = shm_open(name.c_str(), O_CREAT | O_RDWR, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || ((size_t)info.st_size < sizeof(SharedSegment)
+                                      && ftruncate(fd, sizeof(SharedSegment)) != 0)) {
+            close(fd);
+            return false;
+        }
+        void* mapping = mmap(nullptr, sizeof(SharedSegment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (mapping == MAP_FAILED) {
+            return false;
         }
+        segment = static_cast<SharedSegment*>(mapping); // ftruncate zero-fills a new segment
+        segment_name = name;
 
-        page_order.push_back(page_id);
-        memory_map[page_id] = data;
+        uint32_t expected = UNINITIALIZED;
+        if (segment->state.compare_exchange_strong(expected, INITIALIZING)) {
+            for (auto& ring : segment->rings) {
+                ring.enqueue_pos.store(0, memory_order_relaxed);
+                ring.dequeue_pos.store(0, memory_order_relaxed);
+                ring.futex_word.store(0, memory_order_relaxed);
+                ring.waiters.store(0, memory_order_relaxed);
+                for (size_t i = 0; i < RING_CAPACITY; i++) {
+                    ring.cells[i].sequence.store(i, memory_order_relaxed);
+                }
+            }
+            segment->magic = SEGMENT_MAGIC;
+            segment->state.store(READY, memory_order_release);
+        } else {
+            // The segment outlives its creator, so a creator that died while
+            // initializing would otherwise leave every later process spinning
+            auto deadline = chrono::steady_clock::now() + chrono::milliseconds(INIT_TIMEOUT_MS);
+            while (segment->state.load(memory_order_acquire) != READY) {
+                if (chrono::steady_clock::now() >= deadline) {
+                    logger().error("ipc", "[IPC] Segment {} was never initialized; its creator probably exited. "
+                                   "Remove it (shm_unlink, or rm /dev/shm{}) and retry", name, name);
+                    detach();
+                    return false;
+                }
+                this_thread::sleep_for(chrono::milliseconds(1));
+            }
+        }
+        if (segment->magic != SEGMENT_MAGIC) {
+            detach();
+            return false;
+        }
+        return true;
+#else
+        (void)name;
+        return false;
+#endif
+    }
 
-        if (page_order.size() > MAX_PAGES) {
-            int removed_page = page_order.front();
-            page_order.pop_front();
-            memory_map.erase(removed_page);
-            cout << "Removed page: " << removed_page << endl;
+    void detach() {
+#ifdef __linux__
+        if (segment) {
+            munmap(segment, sizeof(SharedSegment));
         }
+#endif
+        segment = nullptr;
+        segment_name.clear();
+    }
 
-        cout << "Accessed memory page: " << page_id << endl;
+    // Remove the segment name; mappings stay valid until every process detaches
+    static void unlink(const string& name) {
+#ifdef __linux__
+        shm_unlink(name.c_str());
+#else
+        (void)name;
+#endif
     }
 
-    void displayMemoryMap() {
-        cout << "\nMemory Map:" << endl;
-        for (const auto& page : memory_map) {
-            cout << "Page " << page.first << ": " << page.second << endl;
-        }
+    bool attached() const {
+        return segment != nullptr;
     }
-};
 
-// --- File Allocation Table ---
-class FileAllocationTable {
-private:
-    map<string, vector<int>> file_blocks;
-    int next_block;
-    
-public:
-    FileAllocationTable() : next_block(0) {}
-    
-    void allocateFile(const string& filename, int size) {
-        vector<int> blocks;
-        for (int i = 0; i < size; i++) {
-            blocks.push_back(next_block++);
-        }
-        file_blocks[filename] = blocks;
-        cout << "[FAT] Allocated " << size << " blocks for file: " << filename << endl;
-        cout << "[FAT] Blocks: ";
-        for (int block : blocks) {
-            cout << block << " ";
+    const string& name() const {
+        return segment_name;
+    }
+
+    static bool validPid(int pid) {
+        return pid > 0 && pid < MAX_PROCESSES;
+    }
+
+    template <typename Fill>
+    bool send(int pid, Fill fill) {
+        SharedRing* ring = ringFor(pid);
+        if (!ring || !mpmcTryEmplace(ring->cells, RING_CAPACITY - 1, ring->enqueue_pos, fill)) {
+            return false;
         }
-        cout << endl;
+#ifdef __linux__
+        atomic_thread_fence(memory_order_seq_cst);
+        if (ring->waiters.load(memory_order_relaxed) > 0) {
+            ring->futex_word.fetch_add(1, memory_order_release);
+            futex(&ring->futex_word, FUTEX_WAKE, INT_MAX, nullptr);
+        }
+#endif
+        return true;
     }
-    
-    void displayFAT() {
-        cout << "\n=== FILE ALLOCATION TABLE ===" << endl;
-        cout << setw(20) << "Filename" << setw(30) << "Allocated Blocks" << endl;
-        cout << string(50, '-') << endl;
-        for (const auto& entry : file_blocks) {
-            cout << setw(20) << entry.first << "    ";
-            for (int block : entry.second) {
-                cout << block << " ";
+
+    // Blocking receive; the message is copied out of the ring in place
+    bool receive(int pid, IPCMessage& message, chrono::milliseconds timeout) {
+        SharedRing* ring = ringFor(pid);
+        if (!ring) {
+            return false;
+        }
+        auto take = [&] {
+            return mpmcTryConsume(ring->cells, RING_CAPACITY - 1, ring->dequeue_pos,
+                                  [&message](const IPCMessage& slot) { message = slot; });
+        };
+        auto deadline = chrono::steady_clock::now() + timeout;
+        while (true) {
+            if (take()) {
+                return true;
             }
-            cout << endl;
+#ifdef __linux__
+            ring->waiters.fetch_add(1, memory_order_seq_cst);
+            atomic_thread_fence(memory_order_seq_cst);
+            uint32_t word = ring->futex_word.load(memory_order_acquire);
+            if (take()) {
+                ring->waiters.fetch_sub(1, memory_order_relaxed);
+                return true;
+            }
+            auto remaining = chrono::duration_cast<chrono::nanoseconds>(deadline - chrono::steady_clock::now());
+            if (remaining.count() <= 0) {
+                ring->waiters.fetch_sub(1, memory_order_relaxed);
+                return false;
+            }
+            timespec wait_time;
+            wait_time.tv_sec = (time_t)(remaining.count() / 1000000000);
+            wait_time.tv_nsec = (long)(remaining.count() % 1000000000);
+            futex(&ring->futex_word, FUTEX_WAIT, word, &wait_time);
+            ring->waiters.fetch_sub(1, memory_order_relaxed);
+#else
+            return false;
+#endif
+        }
+    }
+
+    size_t depth(int pid) const {
+        SharedRing* ring = ringFor(pid);
+        if (!ring) {
+            return 0;
         }
+        size_t head = ring->dequeue_pos.load(memory_order_relaxed);
+        size_t tail = ring->enqueue_pos.load(memory_order_relaxed);
+        return tail > head ? tail - head : 0;
     }
 };
 
-// --- Disk I/O Management with Scheduling ---
-class DiskManager {
+class IPCManager {
 private:
-    vector<int> disk_blocks;
-    FileAllocationTable fat;
+    static const int MAX_PROCESS_QUEUES = 4096; // Valid target PIDs: 1 .. MAX_PROCESS_QUEUES - 1
+    static const size_t PROCESS_QUEUE_CAPACITY = 1024;
+    static const size_t GLOBAL_QUEUE_CAPACITY = 4096;
+    static const uint32_t REPLY_SLOTS = 256; // Synchronous sends in flight at once
+
+    // Rendezvous point for one outstanding synchronous send
+    struct ReplySlot {
+        mutex slot_mutex;
+        condition_variable replied_cv;
+        uint32_t generation = 0;
+        bool replied = false;
+        uint32_t length = 0;
+        char text[IPCMessage::MAX_TEXT];
+    };
+
+    // Per-process channels are created on first use and installed with a CAS
+    atomic<MessageChannel*> process_queues[MAX_PROCESS_QUEUES];
+    MessageChannel global_channel;
+    SharedMemoryTransport shared_transport; // Replaces process_queues once attached
+    unique_ptr<ReplySlot[]> reply_slots;
+    MPMCQueue<uint32_t> free_reply_slots;
+
+    MessageChannel* queueFor(int pid, bool create) {
+        if (pid <= 0 || pid >= MAX_PROCESS_QUEUES) {
+            return nullptr;
+        }
+        MessageChannel* queue = process_queues[pid].load(memory_order_acquire);
+        if (queue || !create) {
+            return queue;
+        }
+        MessageChannel* fresh = new MessageChannel(PROCESS_QUEUE_CAPACITY);
+        if (process_queues[pid].compare_exchange_strong(queue, fresh, memory_order_acq_rel)) {
+            return fresh;
+        }
+        delete fresh; // Another sender installed it first
+        return queue;
+    }
+
+    bool pushGlobal(int source_pid, MessageKind kind, const string& message) {
+        return global_channel.send([&](IPCMessage& slot) {
+            slot.fill(source_pid, 0, kind, message.data(), message.size());
+        });
+    }
+
+    static const chrono::milliseconds DEFAULT_TIMEOUT;
 
 public:
-    void simulateDiskAccessFCFS(const vector<int>& block_requests) {
-        cout << "\n=== DISK SCHEDULING: FCFS (First Come First Serve) ===" << endl;
-        cout << "Request Sequence: ";
-        for (int block : block_requests) {
-            cout << block << " ";
+    IPCManager()
+        : global_channel(GLOBAL_QUEUE_CAPACITY), reply_slots(new ReplySlot[REPLY_SLOTS]),
+          free_reply_slots(REPLY_SLOTS) {
+        for (auto& queue : process_queues) {
+            queue.store(nullptr, memory_order_relaxed);
         }
-        cout << endl;
-        
-        int head = 0;
-        int total_seek_time = 0;
-        
-        cout << "\nSeek Sequence:\n";
-        cout << setw(10) << "From" << setw(10) << "To" << setw(15) << "Seek Time" << endl;
-        cout << string(35, '-') << endl;
-        
-        for (int block : block_requests) {
-            int seek_time = abs(block - head);
-            total_seek_time += seek_time;
-            cout << setw(10) << head << setw(10) << block << setw(15) << seek_time << endl;
-            head = block;
-            disk_blocks.push_back(block);
+        for (uint32_t i = 0; i < REPLY_SLOTS; i++) {
+            free_reply_slots.tryPush(i);
         }
-        
-        cout << "\nTotal Seek Time: " << total_seek_time << endl;
-        cout << "Average Seek Time: " << (double)total_seek_time / block_requests.size() << endl;
     }
-    
-    void simulateDiskAccessSCAN(vector<int> block_requests, int initial_head, int disk_size) {
-        cout << "\n=== DISK SCHEDULING: SCAN (Elevator Algorithm) ===" << endl;
-        sort(block_requests.begin(), block_requests.end());
-        
-        vector<int> left, right;
-        for (int req : block_requests) {
-            if (req < initial_head)
-                left.push_back(req);
-            else
-                right.push_back(req);
+
+    ~IPCManager() {
+        for (auto& queue : process_queues) {
+            delete queue.load(memory_order_relaxed);
+        }
+    }
+
+    IPCManager(const IPCManager&) = delete;
+    IPCManager& operator=(const IPCManager&) = delete;
+
+    // Route process-to-process messages through a shared-memory segment so
+    // separate OS processes attached to the same name can talk to each other
+    bool enableSharedMemory(const string& name) {
+        if (!shared_transport.attach(name)) {
+            logger().error("ipc", "[IPC] Cannot attach shared-memory segment {} (POSIX shared memory is required)", name);
+            return false;
+        }
+        logger().info("ipc", "[IPC] Shared-memory transport attached: {} (PIDs 1-{})", name,
+                      SharedMemoryTransport::MAX_PROCESSES - 1);
+        return true;
+    }
+
+    bool usingSharedMemory() const {
+        return shared_transport.attached();
+    }
+
+    // Send message to specific process (Process-to-Process)
+    bool sendMessageToProcess(int source_pid, int target_pid, const string& message) {
+        auto fill = [&](IPCMessage& slot) {
+            slot.fill(source_pid, target_pid, MessageKind::DATA, message.data(), message.size());
+        };
+        bool sent;
+        if (shared_transport.attached()) {
+            if (!SharedMemoryTransport::validPid(target_pid)) {
+                logger().warn("ipc", "[IPC] Invalid target PID {}", target_pid);
+                return false;
+            }
+            sent = shared_transport.send(target_pid, fill);
+        } else {
+            MessageChannel* queue = queueFor(target_pid, true);
+            if (!queue) {
+                logger().warn("ipc", "[IPC] Invalid target PID {}", target_pid);
+                return false;
+            }
+            sent = queue->send(fill);
         }
-        
-        reverse(left.begin(), left.end());
-        
-        cout << "Initial Head Position: " << initial_head << endl;
-        cout << "Disk Size: " << disk_size << endl;
-        cout << "\nSeek Sequence: " << initial_head << " -> ";
-        
-        int head = initial_head;
-        int total_seek_time = 0;
-        
-        // Move right
-        for (int req : right) {
-            total_seek_time += abs(req - head);
-            head = req;
-            cout << head << " -> ";
+        if (!sent) {
+            logger().warn("ipc", "[IPC] Queue full for PID {}, message dropped", target_pid);
+            return false;
         }
-        
-        // Move to end
-        total_seek_time += abs(disk_size - 1 - head);
-        head = disk_size - 1;
-        cout << head << " -> ";
-        
-        // Move left
-        for (int req : left) {
-            total_seek_time += abs(req - head);
-            head = req;
-            cout << head << " -> ";
+        logger().info("ipc", "[IPC] Process-to-Process Message Sent: [PID {} -> PID {}]: {}", source_pid, target_pid,
+                      message);
+        return true;
+    }
+
+    // Non-blocking receive for programmatic use
+    bool tryReceiveForProcess(int pid, IPCMessage& message) {
+        if (shared_transport.attached()) {
+            return shared_transport.receive(pid, message, chrono::milliseconds(0));
         }
-        
-        cout << "\n\nTotal Seek Time: " << total_seek_time << endl;
-        cout << "Average Seek Time: " << (double)total_seek_time / block_requests.size() << endl;
+        MessageChannel* queue = queueFor(pid, false);
+        return queue && queue->queue.tryPop(message);
     }
-    
-    FileAllocationTable* getFAT() {
-        return &fat;
+
+    bool tryReceive(IPCMessage& message) {
+        return global_channel.queue.tryPop(message);
     }
-};
 
-// --- Inter-Process Communication ---
-class IPCManager {
-private:
-    map<int, queue<string>> process_queues; // Per-process message queues
-    deque<string> global_queue;
-    mutex ipc_mutex;
+    // Blocking receive: sleeps until a message arrives or the timeout passes
+    bool receiveForProcess(int pid, IPCMessage& message, chrono::milliseconds timeout) {
+        if (shared_transport.attached()) {
+            return shared_transport.receive(pid, message, timeout);
+        }
+        MessageChannel* queue = queueFor(pid, true);
+        return queue && queue->receive(message, timeout);
+    }
 
-public:
-    // Send message to specific process (Process-to-Process)
-    void sendMessageToProcess(int source_pid, int target_pid, const string& message) {
-        lock_guard<mutex> lock(ipc_mutex);
-        string formatted_msg = "[PID " + to_string(source_pid) + " -> PID " 
-                              + to_string(target_pid) + "]: " + message;
-        process_queues[target_pid].push(formatted_msg);
-        cout << "[IPC] Process-to-Process Message Sent: " << formatted_msg << endl;
+    bool receive(IPCMessage& message, chrono::milliseconds timeout) {
+        return global_channel.receive(message, timeout);
+    }
+
+    // Acknowledge a SYNC message and wake its sender. Returns false if the
+    // message expects no reply or the sender already gave up.
+    bool reply(const IPCMessage& request, const string& response) {
+        if (request.reply_slot >= REPLY_SLOTS) {
+            return false;
+        }
+        ReplySlot& slot = reply_slots[request.reply_slot];
+        {
+            lock_guard<mutex> lock(timedLock(slot.slot_mutex, Metric::LOCK_IPC_REPLY), adopt_lock);
+            if (slot.generation != request.reply_generation || slot.replied) {
+                return false;
+            }
+            slot.length = (uint32_t)min(response.size(), IPCMessage::MAX_TEXT);
+            memcpy(slot.text, response.data(), slot.length);
+            slot.replied = true;
+        }
+        slot.replied_cv.notify_one();
+        return true;
     }
     
     // Receive message for specific process
-    void receiveMessageForProcess(int pid) {
-        lock_guard<mutex> lock(ipc_mutex);
-        if (!process_queues[pid].empty()) {
-            string message = process_queues[pid].front();
-            process_queues[pid].pop();
-            cout << "[IPC] Process " << pid << " Received: " << message << endl;
+    void receiveMessageForProcess(int pid, chrono::milliseconds timeout = DEFAULT_TIMEOUT) {
+        IPCMessage message;
+        if (receiveForProcess(pid, message, timeout)) {
+            logger().info("ipc", "[IPC] Process {} Received: {}", pid, message.format());
+            if (message.kind == MessageKind::SYNC) {
+                reply(message, "ACK");
+            }
         } else {
-            cout << "[IPC] No messages for Process " << pid << endl;
+            logger().info("ipc", "[IPC] No messages for Process {}", pid);
         }
     }
     
-    // Synchronous message send (wait for acknowledgment)
-    void sendMessageSync(const string& message) {
+    // Synchronous message send: blocks until a receiver replies or the timeout
+    // passes. Returns true when acknowledged; the reply text goes to response.
+    bool sendMessageSync(const string& message, string* response = nullptr,
+                         chrono::milliseconds timeout = DEFAULT_TIMEOUT) {
+        uint32_t index;
+        if (!free_reply_slots.tryPop(index)) {
+            logger().warn("ipc", "[IPC-SYNC] Too many synchronous sends in flight");
+            return false;
+        }
+        ReplySlot& slot = reply_slots[index];
+        uint32_t generation;
         {
-            lock_guard<mutex> lock(ipc_mutex);
-            global_queue.push_back(message);
-            cout << "[IPC-SYNC] Message sent (blocking): " << message << endl;
-        } // Release lock before sleeping
-        // Simulate waiting for acknowledgment
-        this_thread::sleep_for(chrono::milliseconds(100));
-        cout << "[IPC-SYNC] Acknowledgment received" << endl;
+            lock_guard<mutex> lock(timedLock(slot.slot_mutex, Metric::LOCK_IPC_REPLY), adopt_lock);
+            generation = slot.generation;
+            slot.replied = false;
+        }
+
+        auto start = chrono::steady_clock::now();
+        bool sent = global_channel.send([&](IPCMessage& request) {
+            request.fill(0, 0, MessageKind::SYNC, message.data(), message.size());
+            request.reply_slot = index;
+            request.reply_generation = generation;
+        });
+        bool acknowledged = false;
+        string reply_text;
+        if (sent) {
+            logger().info("ipc", "[IPC-SYNC] Message sent (blocking): {}", message);
+            unique_lock<mutex> lock(timedLock(slot.slot_mutex, Metric::LOCK_IPC_REPLY), adopt_lock);
+            acknowledged = slot.replied_cv.wait_until(lock, start + timeout, [&slot] { return slot.replied; });
+            if (acknowledged) {
+                reply_text.assign(slot.text, slot.length);
+            }
+            slot.generation++; // Late replies to this request are ignored
+        } else {
+            logger().warn("ipc", "[IPC-SYNC] Global queue full, message dropped");
+        }
+        free_reply_slots.tryPush(index);
+
+        if (acknowledged) {
+            auto micros = chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - start).count();
+            logger().info("ipc", "[IPC-SYNC] Acknowledgment received ({}) after {} us", reply_text, (long long)micros);
+            if (response) {
+                *response = reply_text;
+            }
+        } else if (sent) {
+            logger().warn("ipc", "[IPC-SYNC] Timed out waiting for acknowledgment");
+        }
+        return acknowledged;
+    }
+
+    // Receive from the global queue until count SYNC messages have been
+    // acknowledged or a receive times out
+    void serveSyncRequests(int count, chrono::milliseconds timeout = DEFAULT_TIMEOUT) {
+        while (count > 0) {
+            IPCMessage message;
+            if (!receive(message, timeout)) {
+                logger().info("ipc", "[IPC] No messages in global queue");
+                return;
+            }
+            logger().info("ipc", "[IPC] Message received: {}", message.format());
+            if (message.kind == MessageKind::SYNC && reply(message, "ACK")) {
+                count--;
+            }
+        }
     }
     
     // Asynchronous message send (no wait)
     void sendMessageAsync(const string& message) {
-        lock_guard<mutex> lock(ipc_mutex);
-        global_queue.push_back(message);
-        cout << "[IPC-ASYNC] Message sent (non-blocking): " << message << endl;
+        if (!pushGlobal(0, MessageKind::ASYNC, message)) {
+            logger().warn("ipc", "[IPC-ASYNC] Global queue full, message dropped");
+            return;
+        }
+        logger().info("ipc", "[IPC-ASYNC] Message sent (non-blocking): {}", message);
         // No waiting, returns immediately
     }
 
-    void receiveMessage() {
-        lock_guard<mutex> lock(ipc_mutex);
-        if (!global_queue.empty()) {
-            string message = global_queue.front();
-            global_queue.pop_front();
-            cout << "[IPC] Message received: " << message << endl;
+    void receiveMessage(chrono::milliseconds timeout = DEFAULT_TIMEOUT) {
+        IPCMessage message;
+        if (receive(message, timeout)) {
+            logger().info("ipc", "[IPC] Message received: {}", message.format());
+            if (message.kind == MessageKind::SYNC) {
+                reply(message, "ACK");
+            }
         } else {
-            cout << "[IPC] No messages in global queue" << endl;
+            logger().info("ipc", "[IPC] No messages in global queue");
         }
     }
     
     // Notify process completion
     void notifyProcessCompletion(int pid) {
-        lock_guard<mutex> lock(ipc_mutex);
-        string notification = "Process " + to_string(pid) + " has completed";
-        global_queue.push_back(notification);
-        cout << "[IPC] Notification: " << notification << endl;
+        bool sent = global_channel.send([pid](IPCMessage& slot) {
+            slot.fill(pid, 0, MessageKind::NOTIFICATION, "", 0);
+        });
+        if (sent) {
+            logger().info("ipc", "[IPC] Notification: Process {} has completed", pid);
+        } else {
+            logger().warn("ipc", "[IPC] Global queue full, notification for Process {} dropped", pid);
+        }
     }
     
+    size_t globalDepth() const {
+        return global_channel.queue.approxSize();
+    }
+
+    // (pid, queued messages) for every process queue in use
+    vector<pair<int, size_t>> processDepths() const {
+        vector<pair<int, size_t>> active;
+        for (int pid = 1; pid < MAX_PROCESS_QUEUES; pid++) {
+            MessageChannel* queue = process_queues[pid].load(memory_order_acquire);
+            if (queue) {
+                active.push_back({pid, queue->queue.approxSize()});
+            }
+        }
+        if (shared_transport.attached()) {
+            for (int pid = 1; pid < SharedMemoryTransport::MAX_PROCESSES; pid++) {
+                if (shared_transport.depth(pid) > 0) {
+                    active.push_back({pid, shared_transport.depth(pid)});
+                }
+            }
+        }
+        return active;
+    }
+
     void displayIPCStatus() {
-        lock_guard<mutex> lock(ipc_mutex);
+        logger().flush();
         cout << "\n=== IPC STATUS ===" << endl;
-        cout << "Global Queue Size: " << global_queue.size() << endl;
-        cout << "Process Queues: " << process_queues.size() << " active" << endl;
-        for (const auto& pq : process_queues) {
-            cout << "  PID " << pq.first << ": " << pq.second.size() << " messages" << endl;
+        cout << "Global Queue Size: " << globalDepth() << " / " << global_channel.queue.capacity() << endl;
+        if (shared_transport.attached()) {
+            cout << "Transport: shared memory " << shared_transport.name() << endl;
+        }
+        vector<pair<int, size_t>> active = processDepths();
+        cout << "Process Queues: " << active.size() << " active" << endl;
+        for (const auto& pq : active) {
+            cout << "  PID " << pq.first << ": " << pq.second << " messages" << endl;
         }
     }
 };
 
+const chrono::milliseconds IPCManager::DEFAULT_TIMEOUT(1000);
+
 // --- Banking System ---
 class BankingSystem {
 private:
     AccountManager account_manager;
     ProcessTable process_table;
+    ThreadPool transaction_pool;
     TransactionManager transaction_manager;
     CPUScheduler cpu_scheduler;
     MemoryManager memory_manager;
     DiskManager disk_manager;
     IPCManager ipc_manager;
+    int metrics_collector;
 
 public:
-    BankingSystem()
-        : transaction_manager(&account_manager, &process_table),
-          cpu_scheduler(&transaction_manager, &process_table) {}
+    explicit BankingSystem(size_t worker_count = 0)
+        : transaction_pool(worker_count),
+          transaction_manager(&account_manager, &process_table, &transaction_pool),
+          cpu_scheduler(&transaction_manager, &process_table) {
+        metrics_collector = metrics().addCollector([this](vector<GaugeSample>& gauges) {
+            gauges.push_back({"os_ipc_queue_depth", "Messages waiting in an IPC queue.", "queue=\"global\"",
+                              (double)ipc_manager.globalDepth()});
+            for (const auto& depth : ipc_manager.processDepths()) {
+                gauges.push_back({"os_ipc_queue_depth", "Messages waiting in an IPC queue.",
+                                  "queue=\"pid\",pid=\"" + to_string(depth.first) + "\"", (double)depth.second});
+            }
+            gauges.push_back({"os_processes_live", "Live entries in the process table.", "",
+                              (double)process_table.liveCount()});
+            gauges.push_back({"os_thread_pool_queued_tasks", "Transactions waiting for a worker.", "",
+                              (double)transaction_pool.queuedTasks()});
+        });
+    }
+
+    ~BankingSystem() {
+        metrics().removeCollector(metrics_collector);
+    }
+
+    // Headless batch mode: apply every record in a text or binary trace.
+    // With workers > 0 the deterministic parallel engine is used; its digest
+    // matches the serial replay's.
+    bool replayTransactions(const string& path, size_t workers = 0) {
+        logger().flush();
+        TransactionTrace trace;
+        if (!trace.open(path)) {
+            cout << "Cannot open trace " << path << endl;
+            return false;
+        }
+        cout << "\n=== TRANSACTION REPLAY ===" << endl;
+        cout << "Trace: " << path << " (" << (trace.format() == TransactionTrace::BINARY ? "binary" : "text");
+        if (trace.format() == TransactionTrace::BINARY) {
+            cout << ", " << trace.declaredRecords() << " records";
+        }
+        cout << ")" << endl;
+
+        ReplayStats stats;
+        bool ok = workers > 0 ? transaction_manager.replayTraceParallel(trace, stats, workers)
+                              : transaction_manager.replayTrace(trace, stats);
+        if (!ok) {
+            cout << "Failed to replay " << path << " (unreadable trace or transaction log)" << endl;
+            return false;
+        }
+        uint64_t failed = stats.not_found + stats.insufficient_funds + stats.duplicate_accounts + stats.invalid_amounts
+                        + stats.invalid_ids + stats.log_failures;
+        cout << "Records: " << stats.records << " (" << stats.applied << " applied, "
+             << failed << " rejected, " << stats.malformed << " malformed)" << endl;
+        cout << "Creates: " << stats.creates << ", Deposits: " << stats.deposits
+             << ", Withdrawals: " << stats.withdrawals << ", Transfers: " << stats.transfers
+             << ", Balance Queries: " << stats.balance_queries << endl;
+        cout << "Rejected: " << stats.not_found << " unknown account, " << stats.insufficient_funds
+             << " insufficient balance, " << stats.duplicate_accounts << " duplicate account, "
+             << stats.invalid_amounts << " invalid amount, " << stats.invalid_ids << " invalid id" << endl;
+        cout << "Outcome Digest: " << hex << setw(16) << setfill('0') << stats.digest << dec << setfill(' ')
+             << (stats.workers ? " (" + to_string(stats.workers) + (stats.workers == 1 ? " worker)" : " workers)")
+                               : string(" (serial)")) << endl;
+        cout << fixed << setprecision(3) << "Elapsed: " << stats.elapsed_seconds << " s";
+        if (stats.elapsed_seconds > 0) {
+            cout << setprecision(0) << " (" << stats.records / stats.elapsed_seconds << " txn/s)";
+        }
+        cout << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+        return true;
+    }
+
+    // Headless address trace replay through the virtual memory subsystem.
+    // Each trace PID becomes a process with its own address space.
+    bool replayAddressTrace(const string& path, size_t frame_count) {
+        logger().flush();
+        AddressTrace trace;
+        if (!trace.open(path)) {
+            cout << "Cannot open address trace " << path << endl;
+            return false;
+        }
+        cout << "\n=== ADDRESS TRACE REPLAY ===" << endl;
+        cout << "Trace: " << path << " (" << (trace.isBinary() ? "binary" : "text");
+        if (trace.isBinary()) {
+            cout << ", " << trace.declaredRecords() << " references";
+        }
+        cout << ")" << endl;
+
+        const uint32_t MAX_TRACE_PID = 1 << 16;
+        VirtualMemoryConfig config;
+        config.frames = frame_count;
+        config.tlb_sets = 64;
+        VirtualMemory memory(&process_table, config);
+        vector<int> pids(MAX_TRACE_PID, 0); // Trace PID -> process table PID
+        uint64_t malformed = 0, unmapped = 0;
+        uint64_t physical;
+        auto start = chrono::steady_clock::now();
+        bool ok = trace.forEach([&](const MemoryReference& reference) {
+            if (reference.pid >= MAX_TRACE_PID) {
+                unmapped++;
+                return;
+            }
+            int& pid = pids[reference.pid];
+            if (pid == 0) {
+                pid = process_table.createProcess("VM-" + to_string(reference.pid));
+                if (pid < 0 || !memory.attach(pid)) {
+                    pid = -1;
+                }
+            }
+            if (pid < 0) {
+                unmapped++;
+                return;
+            }
+            memory.translate(pid, reference.address, reference.flags & MemoryReference::WRITE, physical);
+        }, malformed);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        logger().flush();
+        if (!ok) {
+            cout << "Failed to read address trace " << path << endl;
+            return false;
+        }
+        memory.displayStats();
+        const TranslationStats& stats = memory.getStats();
+        cout << "Skipped: " << malformed << " malformed, " << unmapped << " without a process" << endl;
+        cout << fixed << setprecision(3) << "Elapsed: " << seconds << " s";
+        if (seconds > 0) {
+            cout << setprecision(0) << " (" << (stats.references + stats.invalid) / seconds << " translations/s)";
+        }
+        cout << endl;
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6);
+        for (int pid : pids) {
+            if (pid > 0) {
+                memory.detach(pid);
+                process_table.releaseProcess(pid);
+            }
+        }
+        return true;
+    }
+
+    // Three processes share a small frame pool: one sweeps an array, one
+    // works in a hot set, one touches sparse pages across a large mapping
+    void simulateVirtualMemory() {
+        VirtualMemory memory(&process_table);
+        vector<uint32_t> pids;
+        for (const char* name : {"VM-SWEEP", "VM-LEDGER", "VM-MAPPED"}) {
+            int pid = process_table.createProcess(name);
+            if (pid > 0 && memory.attach(pid)) {
+                pids.push_back((uint32_t)pid);
+            }
+        }
+        logger().flush();
+        if (pids.size() < 3) {
+            cout << "[ERROR] Cannot create the virtual memory processes" << endl;
+            for (uint32_t pid : pids) {
+                memory.detach((int)pid);
+                process_table.releaseProcess((int)pid);
+            }
+            return;
+        }
+
+        vector<MemoryReference> references = AddressTraceGenerator(pids).generate(300000);
+        cout << "\n[VIRTUAL MEMORY DEMO] First translations:" << endl;
+        const size_t SHOWN = 6;
+        for (size_t i = 0; i < SHOWN; i++) {
+            const MemoryReference& reference = references[i * 300]; // Cross time slices
+            TranslationStats before = memory.getStats();
+            uint64_t physical = 0;
+            memory.translate((int)reference.pid, reference.address, reference.flags & MemoryReference::WRITE, physical);
+            const TranslationStats& after = memory.getStats();
+            const char* outcome = after.page_faults > before.page_faults ? "TLB miss, page fault"
+                                  : after.tlb_hits > before.tlb_hits  ? "TLB hit"
+                                                                      : "TLB miss, page walk";
+            cout << "PID " << setw(4) << reference.pid << "  VA 0x" << hex << setw(12) << setfill('0') << reference.address
+                 << " -> PA 0x" << setw(8) << physical << dec << setfill(' ') << "  (" << outcome << ")" << endl;
+        }
+        memory.replay(references);
+        memory.displayStats();
+        for (uint32_t pid : pids) {
+            memory.detach((int)pid);
+            process_table.releaseProcess((int)pid);
+        }
+    }
+
+    bool enableSharedMemoryIPC(const string& name) {
+        return ipc_manager.enableSharedMemory(name);
+    }
+
+    // Headless receiver for one PID: print messages until "quit" arrives or
+    // the channel stays idle for idle_timeout
+    void listenForMessages(int pid, chrono::seconds idle_timeout = chrono::seconds(60)) {
+        logger().flush();
+        cout << "[IPC] Listening for messages to PID " << pid << " (send \"quit\" to stop)" << endl;
+        IPCMessage message;
+        while (ipc_manager.receiveForProcess(pid, message, idle_timeout)) {
+            cout << "[IPC] Process " << pid << " Received: " << message.format() << endl;
+            if (message.body() == "quit") {
+                break;
+            }
+        }
+    }
 
     void menu() {
         while (true) {
+            logger().flush(); // Finish the previous option's log output first
             cout << "\n" << string(60, '=') << endl;
             cout << "===      BANKING SYSTEM - OS SIMULATION MENU          ===" << endl;
             cout << string(60, '=') << endl;
@@ -536,17 +8493,19 @@ public:
             cout << "2. Deposit Money" << endl;
             cout << "3. Withdraw Money" << endl;
             cout << "4. Check Balance" << endl;
+            cout << "17. Transfer Between Accounts" << endl;
             cout << "\n[PROCESS & THREAD MANAGEMENT]" << endl;
             cout << "5. Process Transactions Concurrently (Multithreading)" << endl;
             cout << "6. View Process Table" << endl;
             cout << "\n[CPU SCHEDULING]" << endl;
-            cout << "7. Simulate Round Robin Scheduling with Metrics" << endl;
+            cout << "7. Simulate CPU Scheduling with Metrics (RR/FCFS/SJF/SRTF/Priority/MLFQ/CFS)" << endl;
             cout << "\n[MEMORY MANAGEMENT]" << endl;
-            cout << "8. Simulate Memory Management (LRU Paging)" << endl;
+            cout << "8. Simulate Memory Management (LRU/FIFO/OPT/Clock/LFU/ARC Paging, Virtual Memory)" << endl;
             cout << "\n[DISK I/O & FILE MANAGEMENT]" << endl;
             cout << "9. Simulate Disk Scheduling (FCFS)" << endl;
-            cout << "10. Simulate Disk Scheduling (SCAN)" << endl;
+            cout << "10. Simulate Disk Scheduling (SCAN/SSTF/C-SCAN/LOOK/C-LOOK)" << endl;
             cout << "11. Manage File Allocation Table (FAT)" << endl;
+            cout << "18. Simulate Buffer Cache (Read-Ahead + Write-Back)" << endl;
             cout << "\n[INTER-PROCESS COMMUNICATION]" << endl;
             cout << "12. Send IPC Message (Synchronous)" << endl;
             cout << "13. Send IPC Message (Asynchronous)" << endl;
@@ -587,24 +8546,44 @@ public:
                 cout << "Enter Account ID: ";
                 cin >> account_id;
                 account_manager.checkBalance(account_id);
+            } else if (choice == 17) {
+                string from_id, to_id;
+                double amount;
+                cout << "Enter Source Account ID: ";
+                cin >> from_id;
+                cout << "Enter Destination Account ID: ";
+                cin >> to_id;
+                cout << "Enter Amount to Transfer: ";
+                cin >> amount;
+                account_manager.transfer(from_id, to_id, amount);
             } else if (choice == 5) {
                 cout << "\n[MULTITHREADING DEMO] Processing transactions concurrently...\n";
                 // Ensure account exists
                 account_manager.createAccount("DEMO111", 2000.0);
+                account_manager.createAccount("DEMO222", 1000.0);
+                account_manager.createAccount("DEMO333", 0.0);
                 
-                vector<thread> threads;
+                vector<future<bool>> results;
                 int pid1 = process_table.createProcess("T1");
                 int pid2 = process_table.createProcess("T2");
+                int pid3 = process_table.createProcess("T3");
+                int pid4 = process_table.createProcess("T4");
                 
-                threads.emplace_back(&TransactionManager::createTransaction, &transaction_manager, "T1", "deposit", "DEMO111", 1000.0, pid1);
-                threads.emplace_back(&TransactionManager::createTransaction, &transaction_manager, "T2", "withdraw", "DEMO111", 500.0, pid2);
+                results.push_back(transaction_manager.submitTransaction("T1", "deposit", "DEMO111", 1000.0, pid1));
+                results.push_back(transaction_manager.submitTransaction("T2", "withdraw", "DEMO111", 500.0, pid2));
+                results.push_back(transaction_manager.submitTransaction("T3", "transfer", "DEMO111", 250.0, pid3, "DEMO222"));
+                // Payroll-style batch: one debit split over two credits, all or nothing
+                results.push_back(transaction_manager.submitBatch("T4", {{"DEMO222", -30000}, {"DEMO111", 20000}, {"DEMO333", 10000}}, pid4));
                 
-                for (auto& t : threads) {
-                    t.join();
+                for (auto& result : results) {
+                    result.get();
                 }
+                logger().flush();
                 cout << "All transactions completed!\n";
                 ipc_manager.notifyProcessCompletion(pid1);
                 ipc_manager.notifyProcessCompletion(pid2);
+                ipc_manager.notifyProcessCompletion(pid3);
+                ipc_manager.notifyProcessCompletion(pid4);
                 
             } else if (choice == 6) {
                 process_table.displayProcessTable();
@@ -614,21 +8593,93 @@ public:
                 account_manager.createAccount("SCHED_A1", 1000.0);
                 account_manager.createAccount("SCHED_A2", 500.0);
                 
-                vector<tuple<string, string, string, double>> transactions = {
-                    {"T1", "deposit", "SCHED_A1", 500},
-                    {"T2", "withdraw", "SCHED_A2", 200},
-                    {"T3", "balance", "SCHED_A1", 0},
-                    {"T4", "deposit", "SCHED_A2", 300}};
-                cpu_scheduler.simulateRoundRobin(transactions);
+                // {id, action, account, amount, arrival, burst, priority}
+                vector<ScheduledTransaction> transactions = {
+                    {"T1", "deposit", "SCHED_A1", 500, 0, 5, 2},
+                    {"T2", "withdraw", "SCHED_A2", 200, 1, 3, 3},
+                    {"T3", "balance", "SCHED_A1", 0, 2, 1, 1},
+                    {"T4", "deposit", "SCHED_A2", 300, 3, 4, 2}};
+                // Kernel loop programs: CPU bursts, disk blocks, and sends to a transaction index
+                using Op = OperationKind;
+                transactions[0].program = {{Op::CPU, 2}, {Op::DISK, 98}, {Op::CPU, 1}, {Op::SEND, 2}, {Op::CPU, 2}};
+                transactions[1].program = {{Op::CPU, 1}, {Op::DISK, 183}, {Op::CPU, 1}, {Op::DISK, 37}, {Op::CPU, 1}};
+                transactions[2].program = {{Op::CPU, 1}, {Op::RECEIVE, 0}, {Op::DISK, 122}};
+                transactions[3].program = {{Op::CPU, 3}, {Op::DISK, 14}, {Op::CPU, 1}};
+
+                logger().flush();
+                cout << "Select policy: 1. Round Robin  2. FCFS  3. SJF  4. SRTF  5. Priority (Aging)"
+                     << "  6. MLFQ  7. CFS  8. Compare All  9. Kernel Loop (CPU + Disk + IPC)  10. Multi-Core" << endl;
+                int policy_choice;
+                cin >> policy_choice;
+                if (policy_choice == CPUScheduler::POLICY_COUNT + 1) {
+                    cpu_scheduler.comparePolicies(transactions);
+                } else if (policy_choice == CPUScheduler::POLICY_COUNT + 2) {
+                    cout << "Select policy for the kernel loop (1-" << CPUScheduler::POLICY_COUNT << "): ";
+                    int kernel_policy;
+                    cin >> kernel_policy;
+                    if (auto policy = cpu_scheduler.makePolicy(kernel_policy - 1)) {
+                        cpu_scheduler.simulateKernel(*policy, transactions);
+                    } else {
+                        cout << "[ERROR] Invalid policy!" << endl;
+                    }
+                } else if (policy_choice == CPUScheduler::POLICY_COUNT + 3) {
+                    cout << "Number of CPUs (1-64): ";
+                    int cpu_count;
+                    cin >> cpu_count;
+                    cout << "Select policy for each CPU (1-" << CPUScheduler::POLICY_COUNT << "): ";
+                    int core_policy;
+                    cin >> core_policy;
+                    // Three waves of the demo workload; T1 is pinned to CPU 0
+                    vector<ScheduledTransaction> workload;
+                    for (int wave = 0; wave < 3; wave++) {
+                        for (auto transaction : transactions) {
+                            transaction.id += "." + to_string(wave + 1);
+                            transaction.arrival_time += 2 * wave;
+                            workload.push_back(transaction);
+                        }
+                    }
+                    workload[0].affinity = 1;
+                    cpu_scheduler.simulateMultiCore(core_policy - 1, cpu_count, workload);
+                } else if (auto policy = cpu_scheduler.makePolicy(policy_choice - 1)) {
+                    cpu_scheduler.simulateScheduling(*policy, transactions);
+                } else {
+                    cout << "[ERROR] Invalid policy!" << endl;
+                }
                 
             } else if (choice == 8) {
-                cout << "\n[LRU PAGING DEMO]\n";
-                memory_manager.accessMemoryPage(1, "Account Data - Page 1");
-                memory_manager.accessMemoryPage(2, "Transaction Log - Page 2");
-                memory_manager.accessMemoryPage(3, "User Data - Page 3");
-                memory_manager.accessMemoryPage(4, "Audit Trail - Page 4");
-                memory_manager.accessMemoryPage(1, "Account Data - Page 1 (Re-access)");
-                memory_manager.displayMemoryMap();
+                cout << "Select algorithm: 1. LRU  2. FIFO  3. OPT  4. Clock  5. LFU  6. ARC  7. Compare All"
+                     << "  8. Virtual Memory (page tables + TLB)" << endl;
+                int algorithm;
+                cin >> algorithm;
+                if (algorithm == MemoryManager::POLICY_COUNT + 2) {
+                    simulateVirtualMemory();
+                } else if (algorithm == MemoryManager::POLICY_COUNT + 1) {
+                    // Classic textbook reference string
+                    vector<int> references = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2, 1, 2, 0, 1, 7, 0, 1};
+                    MemoryManager::compareAlgorithms(references, 1, 7);
+                } else if (auto policy = MemoryManager::makePolicy(algorithm - 1)) {
+                    vector<pair<int, string>> accesses = {
+                        {1, "Account Data - Page 1"},
+                        {2, "Transaction Log - Page 2"},
+                        {3, "User Data - Page 3"},
+                        {4, "Audit Trail - Page 4"},
+                        {1, "Account Data - Page 1 (Re-access)"}};
+                    vector<int> references;
+                    for (const auto& access : accesses) {
+                        references.push_back(access.first);
+                    }
+
+                    memory_manager.setPolicy(move(policy));
+                    memory_manager.planReferences(references);
+                    cout << "\n[" << memory_manager.getPolicyName() << " PAGING DEMO]\n";
+                    for (const auto& access : accesses) {
+                        memory_manager.accessMemoryPage(access.first, access.second);
+                    }
+                    memory_manager.displayMemoryMap();
+                    memory_manager.displayStats();
+                } else {
+                    cout << "[ERROR] Invalid algorithm!" << endl;
+                }
                 
             } else if (choice == 9) {
                 vector<int> block_requests = {98, 183, 37, 122, 14, 124, 65, 67};
@@ -638,23 +8689,62 @@ public:
                 vector<int> block_requests = {98, 183, 37, 122, 14, 124, 65, 67};
                 int initial_head = 53;
                 int disk_size = 200;
-                disk_manager.simulateDiskAccessSCAN(block_requests, initial_head, disk_size);
+                cout << "Select algorithm: 1. SCAN  2. SSTF  3. C-SCAN  4. LOOK  5. C-LOOK  6. Compare All" << endl;
+                int algorithm;
+                cin >> algorithm;
+                if (algorithm == 1) {
+                    disk_manager.simulateDiskAccessSCAN(block_requests, initial_head, disk_size);
+                } else if (algorithm >= 2 && algorithm <= DiskManager::ALGORITHM_COUNT) {
+                    disk_manager.simulateDiskAccess(algorithm - 1, block_requests, initial_head, disk_size);
+                } else if (algorithm == DiskManager::ALGORITHM_COUNT + 1) {
+                    DiskManager::compareAlgorithms(block_requests, initial_head, disk_size);
+                } else {
+                    cout << "[ERROR] Invalid algorithm!" << endl;
+                }
                 
             } else if (choice == 11) {
                 FileAllocationTable* fat = disk_manager.getFAT();
+                cout << "Select strategy: 1. First Fit  2. Best Fit  3. Next Fit" << endl;
+                int strategy;
+                cin >> strategy;
+                fat->setStrategy(strategy == 2 ? AllocationStrategy::BEST_FIT
+                                 : strategy == 3 ? AllocationStrategy::NEXT_FIT
+                                                 : AllocationStrategy::FIRST_FIT);
                 cout << "\n[FILE ALLOCATION TABLE MANAGEMENT]\n";
                 fat->allocateFile("transaction_log.txt", 5);
                 fat->allocateFile("account_data.dat", 3);
                 fat->allocateFile("audit_trail.log", 7);
+                fat->deleteFile("account_data.dat");
+                fat->extendFile("transaction_log.txt", 4);
+                fat->allocateFile("customer_index.idx", 2);
+                fat->truncateFile("audit_trail.log", 4);
                 fat->displayFAT();
                 
+            } else if (choice == 18) {
+                size_t capacity;
+                cout << "Enter cache size in blocks: ";
+                cin >> capacity;
+                const size_t REQUESTS = 20000;
+                FileAllocationTable table(1024);
+                vector<BlockRequest> requests;
+                cout << "\n[BUFFER CACHE DEMO] Log-heavy workload on a 1024-block disk\n";
+                vector<string> files = BufferCache::logWorkload(table, REQUESTS, requests, true);
+                BufferCacheConfig config;
+                config.capacity = max<size_t>(1, capacity);
+                BufferCache cache(&table, config);
+                cache.replay(files, requests);
+                cache.displayStats();
+                BufferCache::compareConfigurations({16, 64, 256}, REQUESTS);
+                
             } else if (choice == 12) {
                 string message;
                 cout << "Enter message for synchronous send: ";
                 cin.ignore();
                 getline(cin, message);
+                // A pool worker plays the receiving process and acknowledges the message
+                future<void> receiver = transaction_pool.submit([this] { ipc_manager.serveSyncRequests(1); });
                 ipc_manager.sendMessageSync(message);
-                ipc_manager.receiveMessage();
+                receiver.get();
                 
             } else if (choice == 13) {
                 string message;
@@ -662,6 +8752,7 @@ public:
                 cin.ignore();
                 getline(cin, message);
                 ipc_manager.sendMessageAsync(message);
+                logger().flush();
                 cout << "[INFO] Returned immediately (non-blocking)\n";
                 
             } else if (choice == 14) {
@@ -675,7 +8766,10 @@ public:
                 cin.ignore();
                 getline(cin, message);
                 ipc_manager.sendMessageToProcess(source_pid, target_pid, message);
-                ipc_manager.receiveMessageForProcess(target_pid);
+                // With shared memory the target OS process (--ipc-listen) receives it
+                if (!ipc_manager.usingSharedMemory()) {
+                    ipc_manager.receiveMessageForProcess(target_pid);
+                }
                 
             } else if (choice == 15) {
                 ipc_manager.displayIPCStatus();
@@ -692,9 +8786,765 @@ public:
     }
 };
 
+// --- Benchmarks ---
+// `--bench [FILE]` drives every subsystem with synthetic load and writes the
+// measurements as JSON (default bench_results.json), so results from
+// different builds can be diffed to catch regressions.
+struct BenchmarkResult {
+    string suite;
+    string name;
+    vector<pair<string, double>> params;
+    vector<pair<string, double>> metrics;
+};
+
+class BenchmarkSuite {
+private:
+    vector<BenchmarkResult> results;
+    filesystem::path scratch_dir;
+    mt19937_64 rng{42}; // Fixed seed: every build sees the same workload
+
+    static double secondsSince(chrono::steady_clock::time_point start) {
+        return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    }
+
+    // Nearest-rank percentile of sorted samples
+    static double percentile(const vector<double>& sorted, double p) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        size_t rank = (size_t)ceil(p / 100.0 * sorted.size());
+        return sorted[min(sorted.size(), max<size_t>(rank, 1)) - 1];
+    }
+
+    void record(BenchmarkResult result) {
+        cout << "  " << left << setw(16) << result.suite << setw(16) << result.name << right;
+        for (const auto& param : result.params) {
+            cout << " " << param.first << "=" << jsonNumber(param.second);
+        }
+        cout << " |" << fixed << setprecision(2);
+        for (const auto& metric : result.metrics) {
+            cout << " " << metric.first << "=" << metric.second;
+        }
+        cout.unsetf(ios::floatfield);
+        cout << setprecision(6) << endl;
+        results.push_back(move(result));
+    }
+
+    static string jsonNumber(double value) {
+        if (!isfinite(value)) {
+            return "null";
+        }
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%.10g", value);
+        return buf;
+    }
+
+    static void writeFields(ostream& out, const vector<pair<string, double>>& fields) {
+        out << "{";
+        for (size_t i = 0; i < fields.size(); i++) {
+            out << (i ? ", " : "") << jsonEscape(fields[i].first) << ": " << jsonNumber(fields[i].second);
+        }
+        out << "}";
+    }
+
+    // Mixed deposit/withdraw/balance load; every mutation waits for its group commit
+    void benchAccounts() {
+        const int TOTAL_OPS = 40000;
+        for (int account_count : {16, 10000}) {
+            vector<string> ids;
+            for (int i = 0; i < account_count; i++) {
+                ids.push_back("ACC" + to_string(i));
+            }
+            for (int threads : {1, 2, 4, 8}) {
+                filesystem::path account_file = scratch_dir / "accounts.dat";
+                filesystem::path wal_file = scratch_dir / "accounts.wal";
+                filesystem::remove(account_file);
+                filesystem::remove(wal_file);
+
+                AccountManager manager(account_file.string(), wal_file.string());
+                for (const auto& id : ids) {
+                    manager.createAccountCents(id, 100000000, false);
+                }
+                manager.flushLog();
+
+                int ops_per_thread = TOTAL_OPS / threads;
+                vector<thread> workers;
+                auto start = chrono::steady_clock::now();
+                for (int t = 0; t < threads; t++) {
+                    workers.emplace_back([&, t] {
+                        mt19937 local_rng(t + 1);
+                        long long cents;
+                        for (int i = 0; i < ops_per_thread; i++) {
+                            const string& id = ids[local_rng() % ids.size()];
+                            unsigned dice = local_rng() % 10;
+                            if (dice < 5) {
+                                manager.depositCents(id, 100);
+                            } else if (dice < 9) {
+                                manager.withdrawCents(id, 100);
+                            } else {
+                                manager.balanceCents(id, cents);
+                            }
+                        }
+                    });
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+                double seconds = secondsSince(start);
+                double ops = (double)ops_per_thread * threads;
+                record({"account_manager", "mixed_ops",
+                        {{"threads", (double)threads}, {"accounts", (double)account_count}},
+                        {{"ops", ops}, {"seconds", seconds}, {"ops_per_sec", ops / seconds}}});
+            }
+        }
+    }
+
+    // Random transfers between accounts; money must be conserved at the end
+    void benchTransfers() {
+        const int TOTAL_OPS = 40000;
+        const long long START_CENTS = 100000;
+        for (int account_count : {16, 10000}) {
+            vector<string> ids;
+            for (int i = 0; i < account_count; i++) {
+                ids.push_back("ACC" + to_string(i));
+            }
+            for (int threads : {1, 2, 4, 8}) {
+                filesystem::path account_file = scratch_dir / "accounts.dat";
+                filesystem::path wal_file = scratch_dir / "accounts.wal";
+                filesystem::remove(account_file);
+                filesystem::remove(wal_file);
+
+                AccountManager manager(account_file.string(), wal_file.string());
+                for (const auto& id : ids) {
+                    manager.createAccountCents(id, START_CENTS, false);
+                }
+                manager.flushLog();
+
+                int ops_per_thread = TOTAL_OPS / threads;
+                atomic<long long> rejected(0);
+                vector<thread> workers;
+                auto start = chrono::steady_clock::now();
+                for (int t = 0; t < threads; t++) {
+                    workers.emplace_back([&, t] {
+                        mt19937 local_rng(t + 1);
+                        for (int i = 0; i < ops_per_thread; i++) {
+                            const string& from = ids[local_rng() % ids.size()];
+                            const string& to = ids[local_rng() % ids.size()];
+                            if (manager.transferCents(from, to, 1 + local_rng() % 5000) != AccountStatus::OK) {
+                                rejected.fetch_add(1, memory_order_relaxed);
+                            }
+                        }
+                    });
+                }
+                for (auto& worker : workers) {
+                    worker.join();
+                }
+                double seconds = secondsSince(start);
+                double ops = (double)ops_per_thread * threads;
+
+                long long total = 0, cents = 0;
+                for (const auto& id : ids) {
+                    manager.balanceCents(id, cents);
+                    total += cents;
+                }
+                record({"account_manager", "transfers",
+                        {{"threads", (double)threads}, {"accounts", (double)account_count}},
+                        {{"ops", ops}, {"seconds", seconds}, {"ops_per_sec", ops / seconds},
+                         {"rejected", (double)rejected.load()},
+                         {"conserved", total == START_CENTS * account_count ? 1.0 : 0.0}}});
+            }
+        }
+    }
+
+    // A daily batch: 100000 accounts, then mostly single-account operations
+    // with 5% transfers. The parallel engine must reproduce the serial digest.
+    void benchReplay() {
+        const int ACCOUNTS = 100000;
+        const int OPERATIONS = 1000000;
+        vector<TraceRecord> records;
+        auto add = [&](TraceOp op, int account, long long cents) {
+            TraceRecord record;
+            memset(&record, 0, sizeof(record));
+            record.op = (uint8_t)op;
+            snprintf(record.account_id, sizeof(record.account_id), "ACC%d", account);
+            record.amount_cents = cents;
+            records.push_back(record);
+        };
+        for (int i = 0; i < ACCOUNTS; i++) {
+            add(TraceOp::CREATE, i, 100000);
+        }
+        for (int i = 0; i < OPERATIONS; i++) {
+            int account = (int)(rng() % ACCOUNTS);
+            long long cents = 1 + (long long)(rng() % 20000);
+            switch (rng() % 20) {
+            case 0:
+                add(TraceOp::TRANSFER, account, cents);
+                add(TraceOp::TRANSFER_TO, (int)(rng() % ACCOUNTS), cents);
+                break;
+            case 1: case 2: case 3: add(TraceOp::BALANCE, account, 0); break;
+            case 4: case 5: case 6: case 7: case 8: add(TraceOp::WITHDRAW, account, cents); break;
+            default: add(TraceOp::DEPOSIT, account, cents); break;
+            }
+        }
+        // Records a binary trace can hold but the text parser rejects: every
+        // replay must refuse them instead of moving money
+        const uint64_t INVALID_AMOUNTS = 4, INVALID_IDS = 1;
+        add(TraceOp::WITHDRAW, 0, -500000);
+        add(TraceOp::DEPOSIT, 0, -300);
+        add(TraceOp::CREATE, ACCOUNTS, -999);
+        add(TraceOp::TRANSFER, 0, -100);
+        add(TraceOp::TRANSFER_TO, 1, -100);
+        add(TraceOp::CREATE, 0, 100);
+        memset(records.back().account_id, 0, sizeof(records.back().account_id));
+        string trace_path = (scratch_dir / "replay.trace").string();
+        if (!TransactionTrace::writeBinary(trace_path, records)) {
+            cout << "Cannot write " << trace_path << endl;
+            return;
+        }
+
+        unsigned hardware = max(1u, thread::hardware_concurrency());
+        vector<size_t> worker_counts = {0, 1};
+        if (hardware > 1) {
+            worker_counts.push_back(hardware);
+        }
+        double serial_seconds = 0;
+        uint64_t serial_digest = 0;
+        for (size_t workers : worker_counts) {
+            filesystem::path account_file = scratch_dir / "accounts.dat";
+            filesystem::path wal_file = scratch_dir / "accounts.wal";
+            filesystem::remove(account_file);
+            filesystem::remove(wal_file);
+            ThreadPool pool(max<size_t>(1, workers));
+            AccountManager manager(account_file.string(), wal_file.string());
+            TransactionManager transactions(&manager, nullptr, &pool);
+            TransactionTrace trace;
+            ReplayStats stats;
+            if (!trace.open(trace_path) || !(workers ? transactions.replayTraceParallel(trace, stats, workers)
+                                                     : transactions.replayTrace(trace, stats))) {
+                cout << "Cannot replay " << trace_path << endl;
+                return;
+            }
+            if (workers == 0) {
+                serial_seconds = stats.elapsed_seconds;
+                serial_digest = stats.digest;
+            }
+            record({"replay", workers ? "parallel" : "serial", {{"workers", (double)workers}, {"transactions", (double)stats.records}},
+                    {{"txn_per_sec", stats.records / stats.elapsed_seconds},
+                     {"speedup", serial_seconds / stats.elapsed_seconds},
+                     {"matches_serial", stats.digest == serial_digest ? 1.0 : 0.0},
+                     {"rejects_invalid", stats.invalid_amounts == INVALID_AMOUNTS && stats.invalid_ids == INVALID_IDS ? 1.0 : 0.0}}});
+        }
+    }
+
+    void benchProcessTable() {
+        for (int count : {1000, 100000}) {
+            ProcessTable table;
+            vector<int> pids;
+            pids.reserve(count);
+            auto start = chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) {
+                pids.push_back(table.createProcess("T" + to_string(i), i, 1 + i % 7));
+            }
+            double create_seconds = secondsSince(start);
+
+            start = chrono::steady_clock::now();
+            for (int pid : pids) {
+                table.updateStatus(pid, ProcessState::RUNNING);
+            }
+            double update_seconds = secondsSince(start);
+
+            // Release every PID and allocate again from the free list
+            start = chrono::steady_clock::now();
+            for (int pid : pids) {
+                table.releaseProcess(pid);
+            }
+            for (int i = 0; i < count; i++) {
+                table.createProcess("R" + to_string(i));
+            }
+            double reuse_seconds = secondsSince(start);
+            record({"process_table", "create_update", {{"processes", (double)count}},
+                    {{"creates_per_sec", count / create_seconds}, {"updates_per_sec", count / update_seconds},
+                     {"release_reuse_per_sec", count / reuse_seconds}}});
+        }
+    }
+
+    // Cost of instrumentation: one recorded sample, and a non-durable
+    // transfer load (stripe, WAL and shard locks) with metrics off and on
+    void benchMetrics() {
+        bool was_enabled = metrics().enabled();
+        metrics().setEnabled(true);
+        const int SAMPLES = 1000000;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < SAMPLES; i++) {
+            metrics().finish(Metric::TXN_BALANCE, metrics().start());
+        }
+        double seconds = secondsSince(start);
+        record({"metrics", "record_sample", {}, {{"samples", (double)SAMPLES}, {"ns_per_sample", seconds * 1e9 / SAMPLES}}});
+
+        const int OPS_PER_THREAD = 50000;
+        const int THREADS = 8;
+        vector<string> ids;
+        for (int i = 0; i < 64; i++) {
+            ids.push_back("ACC" + to_string(i));
+        }
+        double elapsed[2];
+        for (int enabled = 0; enabled < 2; enabled++) {
+            filesystem::path account_file = scratch_dir / "accounts.dat";
+            filesystem::path wal_file = scratch_dir / "accounts.wal";
+            filesystem::remove(account_file);
+            filesystem::remove(wal_file);
+            AccountManager manager(account_file.string(), wal_file.string());
+            for (const auto& id : ids) {
+                manager.createAccountCents(id, 100000000, false);
+            }
+            metrics().setEnabled(enabled == 1);
+            vector<thread> workers;
+            start = chrono::steady_clock::now();
+            for (int t = 0; t < THREADS; t++) {
+                workers.emplace_back([&, t] {
+                    mt19937 local_rng(t + 1);
+                    for (int i = 0; i < OPS_PER_THREAD; i++) {
+                        long long started = metrics().start();
+                        bool ok = manager.transferCents(ids[local_rng() % ids.size()], ids[local_rng() % ids.size()],
+                                                        100, false) == AccountStatus::OK;
+                        metrics().finish(Metric::TXN_TRANSFER, started, ok);
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            elapsed[enabled] = secondsSince(start);
+            manager.flushLog();
+        }
+        double ops = (double)OPS_PER_THREAD * THREADS;
+        record({"metrics", "transfer_overhead", {{"threads", (double)THREADS}},
+                {{"ops_per_sec_off", ops / elapsed[0]}, {"ops_per_sec_on", ops / elapsed[1]},
+                 {"overhead_pct", (elapsed[1] / elapsed[0] - 1) * 100}}});
+        metrics().setEnabled(was_enabled);
+    }
+
+    // Skewed reference string: 80% of accesses go to 20% of the pages
+    void benchMemory() {
+        const size_t REFERENCES = 1000000;
+        const int PAGES = 1024, HOT_PAGES = PAGES / 5;
+        const size_t FRAMES = 64;
+        vector<int> references(REFERENCES);
+        for (auto& page : references) {
+            page = (rng() % 10 < 8) ? (int)(rng() % HOT_PAGES) : (int)(rng() % PAGES);
+        }
+        for (int index = 0; index < MemoryManager::POLICY_COUNT; index++) {
+            MemoryManager memory(FRAMES);
+            memory.setPolicy(MemoryManager::makePolicy(index));
+            auto start = chrono::steady_clock::now();
+            PagingStats stats = memory.replayTrace(references);
+            double seconds = secondsSince(start);
+            record({"memory_manager", memory.getPolicyName(),
+                    {{"frames", (double)FRAMES}, {"pages", (double)PAGES}, {"references", (double)REFERENCES}},
+                    {{"accesses_per_sec", REFERENCES / seconds},
+                     {"hit_ratio", stats.accesses ? (double)stats.hits / stats.accesses : 0}}});
+        }
+    }
+
+    // Address translation throughput and TLB hit ratio for two TLB sizes
+    void benchVirtualMemory() {
+        const size_t REFERENCES = 20000000;
+        const size_t FRAMES = 1024;
+        ProcessTable table;
+        vector<uint32_t> pids;
+        for (int i = 0; i < 4; i++) {
+            pids.push_back((uint32_t)table.createProcess("VM-BENCH"));
+        }
+        vector<MemoryReference> references = AddressTraceGenerator(pids).generate(REFERENCES);
+        for (auto geometry : {make_pair(16, 4), make_pair(64, 8)}) {
+            VirtualMemoryConfig config;
+            config.frames = FRAMES;
+            config.tlb_sets = geometry.first;
+            config.tlb_ways = geometry.second;
+            VirtualMemory memory(&table, config);
+            for (uint32_t pid : pids) {
+                memory.attach((int)pid);
+            }
+            auto start = chrono::steady_clock::now();
+            TranslationStats stats = memory.replay(references);
+            double seconds = secondsSince(start);
+            record({"virtual_memory", "translate",
+                    {{"tlb_entries", (double)(geometry.first * geometry.second)}, {"frames", (double)FRAMES},
+                     {"references", (double)REFERENCES}},
+                    {{"translations_per_sec", REFERENCES / seconds},
+                     {"tlb_hit_ratio", stats.tlbHitRate() / 100},
+                     {"page_faults", (double)stats.page_faults},
+                     {"eat_ns_without_faults", memory.effectiveAccessTime(false)}}});
+        }
+    }
+
+    // Physical I/O the buffer cache removes from the log workload
+    void benchBufferCache() {
+        const size_t REQUESTS = 1000000;
+        for (size_t capacity : {64, 256, 1024}) {
+            FileAllocationTable table(1024);
+            vector<BlockRequest> requests;
+            vector<string> files = BufferCache::logWorkload(table, REQUESTS, requests);
+            BufferCacheConfig config;
+            config.capacity = capacity;
+            BufferCache cache(&table, config);
+            auto start = chrono::steady_clock::now();
+            BufferCacheStats stats = cache.replay(files, requests);
+            double seconds = secondsSince(start);
+            record({"buffer_cache", "log_workload", {{"capacity", (double)capacity}, {"requests", (double)REQUESTS}},
+                    {{"requests_per_sec", REQUESTS / seconds},
+                     {"hit_ratio", stats.hitRate() / 100},
+                     {"disk_requests_removed_pct", stats.requestsRemoved()},
+                     {"seek_removed_pct", stats.seekRemoved()}}});
+        }
+    }
+
+    // Each analysis over a mapped 32M-row columnar trace, by worker count;
+    // the seek kernel also runs scalar for comparison
+    void benchTraceAnalytics() {
+        const uint64_t ROWS = 1 << 25;
+        string path = (scratch_dir / "trace.col").string();
+        ColumnarTrace trace;
+        if (!ColumnarTrace::generate(path, ROWS) || !trace.open(path)) {
+            cout << "Cannot write columnar trace " << path << endl;
+            return;
+        }
+        uint64_t page_count = 0, disk_size = 0;
+        const uint32_t* pages = trace.column("page", page_count);
+        const uint32_t* blocks = trace.column("block", disk_size);
+        unsigned hardware = max(1u, thread::hardware_concurrency());
+        vector<unsigned> thread_counts = {1};
+        if (hardware > 1) {
+            thread_counts.push_back(hardware);
+        }
+        for (unsigned threads : thread_counts) {
+            auto start = chrono::steady_clock::now();
+            ReuseProfile reuse = TraceAnalyzer::reuseDistances(pages, ROWS, page_count, threads);
+            double seconds = secondsSince(start);
+            record({"trace_analytics", "reuse_distance", {{"threads", (double)threads}, {"rows", (double)ROWS}},
+                    {{"rows_per_sec", ROWS / seconds}, {"fault_rate_4096_frames", (double)reuse.lruFaults(4096) / ROWS}}});
+
+            start = chrono::steady_clock::now();
+            WorkingSetProfile working = TraceAnalyzer::workingSet(pages, ROWS, page_count, 100000, threads);
+            seconds = secondsSince(start);
+            record({"trace_analytics", "working_set", {{"threads", (double)threads}, {"window", 100000.0}},
+                    {{"rows_per_sec", ROWS / seconds}, {"windows", (double)working.sizes.size()}}});
+
+            for (bool simd : {false, true}) {
+                if (simd && !TraceAnalyzer::simdAvailable()) {
+                    continue;
+                }
+                start = chrono::steady_clock::now();
+                SeekProfile seeks = TraceAnalyzer::seekDistances(blocks, ROWS, threads, simd);
+                seconds = secondsSince(start);
+                record({"trace_analytics", simd ? "seek_distance_avx2" : "seek_distance_scalar",
+                        {{"threads", (double)threads}, {"rows", (double)ROWS}},
+                        {{"rows_per_sec", ROWS / seconds}, {"mean_seek", (double)seeks.total / seeks.requests}}});
+            }
+        }
+    }
+
+    // Runtime of each disk scheduler as the request queue grows
+    void benchDisk() {
+        const int DISK_SIZE = 1 << 20;
+        for (size_t length : {1000, 10000, 100000, 1000000}) {
+            vector<int> requests(length);
+            for (auto& block : requests) {
+                block = (int)(rng() % DISK_SIZE);
+            }
+            int head = DISK_SIZE / 2;
+            for (int index = -1; index < DiskManager::ALGORITHM_COUNT; index++) {
+                auto start = chrono::steady_clock::now();
+                DiskScheduleResult result = index < 0 ? DiskManager::scheduleFCFS(requests, head)
+                                                      : DiskManager::schedule(index, requests, head, DISK_SIZE);
+                double seconds = secondsSince(start);
+                record({"disk_scheduler", result.algorithm, {{"queue_length", (double)length}},
+                        {{"milliseconds", seconds * 1000}, {"requests_per_sec", length / seconds}}});
+            }
+        }
+    }
+
+    void benchIPC() {
+        // Throughput: producers flood one process queue, one consumer drains it
+        const int MESSAGES = 200000;
+        const string payload = "transfer ACC1 -> ACC2 100.00";
+        for (int producers : {1, 2, 4}) {
+            IPCManager ipc;
+            int per_producer = MESSAGES / producers;
+            int expected = per_producer * producers;
+            double seconds;
+            {
+                auto start = chrono::steady_clock::now();
+                thread consumer([&] {
+                    IPCMessage message;
+                    for (int received = 0; received < expected;) {
+                        if (ipc.receiveForProcess(1, message, chrono::milliseconds(1000))) {
+                            received++;
+                        } else {
+                            break;
+                        }
+                    }
+                });
+                vector<thread> senders;
+                for (int p = 0; p < producers; p++) {
+                    senders.emplace_back([&, p] {
+                        for (int i = 0; i < per_producer; i++) {
+                            while (!ipc.sendMessageToProcess(2 + p, 1, payload)) {
+                                this_thread::yield(); // Queue full
+                            }
+                        }
+                    });
+                }
+                for (auto& sender : senders) {
+                    sender.join();
+                }
+                consumer.join();
+                seconds = secondsSince(start);
+            }
+            record({"ipc", "process_queue", {{"producers", (double)producers}, {"messages", (double)expected}},
+                    {{"messages_per_sec", expected / seconds}}});
+        }
+
+        // Latency: synchronous request/reply round trips through the global queue
+        const int ROUND_TRIPS = 20000;
+        IPCManager ipc;
+        vector<double> latencies;
+        latencies.reserve(ROUND_TRIPS);
+        {
+            thread server([&] { ipc.serveSyncRequests(ROUND_TRIPS); });
+            for (int i = 0; i < ROUND_TRIPS; i++) {
+                auto start = chrono::steady_clock::now();
+                if (ipc.sendMessageSync(payload)) {
+                    latencies.push_back(secondsSince(start) * 1e6);
+                }
+            }
+            server.join();
+        }
+        sort(latencies.begin(), latencies.end());
+        record({"ipc", "sync_round_trip", {{"round_trips", (double)ROUND_TRIPS}},
+                {{"p50_us", percentile(latencies, 50)}, {"p90_us", percentile(latencies, 90)},
+                 {"p99_us", percentile(latencies, 99)}, {"p999_us", percentile(latencies, 99.9)},
+                 {"max_us", latencies.empty() ? 0 : latencies.back()},
+                 {"completed", (double)latencies.size()}}});
+    }
+
+    bool writeJson(const string& output_path) {
+        ofstream out(output_path);
+        if (!out) {
+            return false;
+        }
+        out << "{\n  \"schema\": 1,\n  \"timestamp\": " << (long long)time(nullptr)
+            << ",\n  \"hardware_concurrency\": " << thread::hardware_concurrency() << ",\n  \"results\": [\n";
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& result = results[i];
+            out << "    {\"suite\": " << jsonEscape(result.suite) << ", \"name\": " << jsonEscape(result.name)
+                << ", \"params\": ";
+            writeFields(out, result.params);
+            out << ", \"metrics\": ";
+            writeFields(out, result.metrics);
+            out << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n}\n";
+        return (bool)out;
+    }
+
+public:
+    bool run(const string& output_path) {
+        scratch_dir = filesystem::temp_directory_path() / ("os_bench_" + to_string(chrono::steady_clock::now().time_since_epoch().count()));
+        filesystem::create_directories(scratch_dir);
+
+        // Measure the operations themselves; log records are filtered at the call site
+        logger().flush();
+        logger().setLevel(LogLevel::OFF);
+        cout << "\n=== BENCHMARKS ===" << endl;
+        benchAccounts();
+        benchTransfers();
+        benchReplay();
+        benchMetrics();
+        benchProcessTable();
+        benchMemory();
+        benchVirtualMemory();
+        benchDisk();
+        benchBufferCache();
+        benchTraceAnalytics();
+        benchIPC();
+        filesystem::remove_all(scratch_dir);
+        logger().setLevel(LogLevel::INFO);
+
+        if (!writeJson(output_path)) {
+            cout << "Cannot write " << output_path << endl;
+            return false;
+        }
+        cout << "Wrote " << results.size() << " results to " << output_path << endl;
+        return true;
+    }
+};
+
 // --- Main Function ---
-int main() {
+// Options:
+//   --shm-ipc [/name]   exchange process-to-process messages through POSIX
+//                       shared memory (default name /os_banking_ipc)
+//   --ipc-listen PID    receive messages for PID without the menu
+//   --replay FILE       apply a text or binary transaction trace and exit
+//   --replay-parallel FILE [WORKERS]
+//                       the same, with accounts replayed in parallel on
+//                       WORKERS threads (default: one per core); the results
+//                       and outcome digest match --replay
+//   --convert-trace IN OUT
+//                       rewrite a text trace in the binary trace format
+//   --import-accounts TEXT [FILE]
+//                       convert a text account snapshot ("ID balance" lines)
+//                       into the binary account file (default accounts.dat)
+//   --vm-replay FILE [FRAMES]
+//                       translate an address trace through page tables and
+//                       a TLB with FRAMES physical frames (default 4096)
+//   --vm-generate FILE COUNT
+//                       write a synthetic binary address trace
+//   --analyze-trace FILE [WINDOW [QUEUE_DEPTH]]
+//                       characterize a columnar trace: reuse distances,
+//                       working sets per WINDOW references (default 100000)
+//                       and seek distances (default queue depth 32)
+//   --columnar-generate FILE ROWS
+//                       write a synthetic columnar trace with page and block columns
+//   --columnar-convert IN OUT
+//                       rewrite an address trace as a columnar page column
+//   --bench [FILE]      run the benchmark suite and write JSON results
+//   --log-level LEVEL   debug, info (default), warn, error or off
+//   --log-json FILE     also append every log record to FILE as JSON lines
+//   --metrics-file FILE rewrite FILE with Prometheus metrics every second
+//   --metrics-socket PATH
+//                       serve Prometheus metrics on a Unix domain socket
+int main(int argc, char* argv[]) {
+    string metrics_file, metrics_socket;
+    string shm_name;
+    string replay_path;
+    size_t replay_workers = 0;
+    string vm_trace_path;
+    size_t vm_frames = 4096;
+    int listen_pid = 0;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--shm-ipc") {
+            shm_name = (i + 1 < argc && argv[i + 1][0] == '/') ? argv[++i] : "/os_banking_ipc";
+        } else if (arg == "--ipc-listen" && i + 1 < argc) {
+            listen_pid = atoi(argv[++i]);
+        } else if (arg == "--replay" && i + 1 < argc) {
+            replay_path = argv[++i];
+        } else if (arg == "--replay-parallel" && i + 1 < argc) {
+            replay_path = argv[++i];
+            replay_workers = max(1u, thread::hardware_concurrency());
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                replay_workers = (size_t)max(1, atoi(argv[++i]));
+            }
+        } else if (arg == "--convert-trace" && i + 2 < argc) {
+            uint64_t written = 0, malformed = 0;
+            if (!TransactionTrace::convert(argv[i + 1], argv[i + 2], written, malformed)) {
+                cerr << "Cannot convert " << argv[i + 1] << " to " << argv[i + 2] << endl;
+                return 1;
+            }
+            cout << "Wrote " << written << " records to " << argv[i + 2]
+                 << " (" << malformed << " malformed lines skipped)" << endl;
+            return 0;
+        } else if (arg == "--vm-replay" && i + 1 < argc) {
+            vm_trace_path = argv[++i];
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                vm_frames = (size_t)max(1, atoi(argv[++i]));
+            }
+        } else if (arg == "--vm-generate" && i + 2 < argc) {
+            uint64_t count = strtoull(argv[i + 2], nullptr, 10);
+            if (!AddressTrace::generate(argv[i + 1], count, 4)) {
+                cerr << "Cannot write address trace " << argv[i + 1] << endl;
+                return 1;
+            }
+            cout << "Wrote " << count << " references to " << argv[i + 1] << endl;
+            return 0;
+        } else if (arg == "--analyze-trace" && i + 1 < argc) {
+            string path = argv[++i];
+            uint64_t window = 100000;
+            size_t queue_depth = 32;
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                window = max<uint64_t>(1, strtoull(argv[++i], nullptr, 10));
+            }
+            if (i + 1 < argc && argv[i + 1][0] != '-') {
+                queue_depth = (size_t)max(1, atoi(argv[++i]));
+            }
+            return TraceAnalyzer::analyze(path, window, queue_depth) ? 0 : 1;
+        } else if (arg == "--columnar-generate" && i + 2 < argc) {
+            uint64_t rows = strtoull(argv[i + 2], nullptr, 10);
+            if (!ColumnarTrace::generate(argv[i + 1], rows)) {
+                cerr << "Cannot write columnar trace " << argv[i + 1] << endl;
+                return 1;
+            }
+            cout << "Wrote " << rows << " rows to " << argv[i + 1] << endl;
+            return 0;
+        } else if (arg == "--columnar-convert" && i + 2 < argc) {
+            uint64_t rows = 0, distinct = 0, malformed = 0;
+            if (!ColumnarTrace::fromAddressTrace(argv[i + 1], argv[i + 2], rows, distinct, malformed)) {
+                cerr << "Cannot convert " << argv[i + 1] << " to " << argv[i + 2] << endl;
+                return 1;
+            }
+            cout << "Wrote " << rows << " rows (" << distinct << " distinct pages) to " << argv[i + 2]
+                 << ", skipped " << malformed << " malformed lines" << endl;
+            return 0;
+        } else if (arg == "--import-accounts" && i + 1 < argc) {
+            string text_path = argv[++i];
+            string account_path = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "accounts.dat";
+            uint64_t imported = 0, skipped = 0;
+            if (!AccountFile::importText(text_path, account_path, imported, skipped)) {
+                cerr << "Cannot import " << text_path << " into " << account_path << endl;
+                return 1;
+            }
+            cout << "Imported " << imported << " accounts into " << account_path
+                 << " (" << skipped << " malformed lines skipped)" << endl;
+            return 0;
+        } else if (arg == "--metrics-file" && i + 1 < argc) {
+            metrics_file = argv[++i];
+        } else if (arg == "--metrics-socket" && i + 1 < argc) {
+            metrics_socket = argv[++i];
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            string level = argv[++i];
+            const char* names[] = {"debug", "info", "warn", "error", "off"};
+            auto found = find(begin(names), end(names), level);
+            if (found == end(names)) {
+                cerr << "Unknown log level: " << level << endl;
+                return 1;
+            }
+            logger().setLevel((LogLevel)(found - begin(names)));
+        } else if (arg == "--log-json" && i + 1 < argc) {
+            if (!logger().openJsonOutput(argv[++i])) {
+                cerr << "Cannot open log file " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--bench") {
+            string output_path = (i + 1 < argc && argv[i + 1][0] != '-') ? argv[++i] : "bench_results.json";
+            BenchmarkSuite suite;
+            return suite.run(output_path) ? 0 : 1;
+        } else {
+            cerr << "Unknown option: " << arg << endl;
+            return 1;
+        }
+    }
+
     BankingSystem banking_system;
+    // Declared after the system so its final write still sees the system's gauges
+    MetricsExporter metrics_exporter;
+    if ((!metrics_file.empty() || !metrics_socket.empty()) && !metrics_exporter.start(metrics_file, metrics_socket)) {
+        cerr << "Cannot export metrics to " << (metrics_socket.empty() ? metrics_file : metrics_socket) << endl;
+        return 1;
+    }
+    if (!shm_name.empty() && !banking_system.enableSharedMemoryIPC(shm_name)) {
+        return 1;
+    }
+    if (listen_pid > 0) {
+        banking_system.listenForMessages(listen_pid);
+        return 0;
+    }
+    if (!replay_path.empty()) {
+        return banking_system.replayTransactions(replay_path, replay_workers) ? 0 : 1;
+    }
+    if (!vm_trace_path.empty()) {
+        return banking_system.replayAddressTrace(vm_trace_path, vm_frames) ? 0 : 1;
+    }
     banking_system.menu();
     return 0;
 }